@@ -21,6 +21,7 @@
 #define DCM_ACCESSGRAPH_HPP
 
 #include <map>
+#include <unordered_map>
 
 #include <boost/graph/properties.hpp>
 #include <boost/graph/adjacency_list.hpp>
@@ -47,6 +48,7 @@
 #include <boost/bind.hpp>
 
 #include "opendcm/core/property.hpp"
+#include "opendcm/core/pool.hpp"
 
 #include <Eigen/Core>
 
@@ -154,7 +156,7 @@ struct Group {
  * @}
  */
 
-typedef boost::adjacency_list_traits<boost::listS, boost::listS, boost::undirectedS> list_traits;
+typedef boost::adjacency_list_traits<pool_listS, pool_listS, boost::undirectedS> list_traits;
 
 
 /**
@@ -271,9 +273,26 @@ struct MultiEdgeProperty {
     struct  change_tracking{}; 
 };
 
+/**
+ * @brief Store the subcluster a vertex represents
+ *
+ * Cluster vertices hold a pointer to the graph they stand for, plain geometry vertices a null pointer.
+ * This allows to check and access subclusters directly from the vertex without a search. The pointer
+ * does not own the subcluster, this is done by the graph holding the vertex.
+ **/
+struct Subcluster {
+    typedef AccessGraphBase* type;
+    
+    struct default_value {
+        AccessGraphBase* operator()() {
+            return nullptr;
+        };
+    };
+};
+
 //Define vertex and edge properties which are always added for use in the boost graph library algorithms
 //or which are needed in the internal algorithms
-typedef mpl::vector5<Index, Color, Group, Type, VertexProperty> bgl_v_props;
+typedef mpl::vector6<Index, Color, Group, Type, VertexProperty, Subcluster> bgl_v_props;
 typedef mpl::vector4<Index, Color, Group, Type> bgl_e_props;
 typedef mpl::vector1<EdgeProperty>  bgl_ge_props;
 typedef mpl::vector2<Type, changed> bgl_c_props;
@@ -430,7 +449,7 @@ public:
     /**
      * @brief The adjacency_list type the AccessGraph uses under the hood
      **/
-    typedef graph_base < boost::listS, boost::listS,
+    typedef graph_base < pool_listS, pool_listS,
             boost::undirectedS, vertex_bundle, edge_bundle > Graph;
 
     typedef std::enable_shared_from_this<AccessGraph<edge_prop, globaledge_prop, vertex_prop, 
@@ -588,7 +607,9 @@ public:
     /**
      * @brief Returns the edge between the local vertices
      *
-     * This function is the same as boost::edge(source, target, Graph) and only added for convienience.
+     * This function is the same as boost::edge(source, target, Graph), but uses the neighbour hash of 
+     * the vertices if available. Hence it is constant time for high degree vertices instead of linear in 
+     * their degree.
      *
      * @param source LocalVertex as edge source
      * @param target LocalVertex as edge target
@@ -887,12 +908,89 @@ public:
     };
 
 
+    /**
+     * @brief Set the degree from which on vertices get a neighbour hash
+     * 
+     * Edge lookup in the adjacency list is linear in the vertex degree, which is expensive for clusters
+     * with thousands of incident edges. Vertices reaching the given degree therefore get a hash mapping 
+     * every neighbour to the connecting local edge. The hash is only changed by graph structure 
+     * modifications, never by lookups, hence \ref edge stays reentrant.
+     * 
+     * @param degree The minimal degree for hashed vertices, 0 disables hashing
+     */
+    void setNeighbourHashDegree(std::size_t degree) {
+        m_hashDegree = degree;
+        rebuildNeighbourHash();
+    };
+    
+    //true if the vertex currently uses a neighbour hash
+    bool hasNeighbourHash(LocalVertex v) const {
+        return m_neighbours.find(v) != m_neighbours.end();
+    };
+
     /********************************************************
     * Stuff
     * *******************************************************/
 
+protected:
+    typedef std::unordered_map<LocalVertex, LocalEdge> NeighbourMap;
+    
+    //neighbour hash maintenance, must be called for all structure changes of the graph
+    void hashEdge(LocalEdge e) {
+        
+        const LocalVertex s = boost::source(e, m_graph), t = boost::target(e, m_graph);
+        for(LocalVertex v : {s, t}) {
+            auto it = m_neighbours.find(v);
+            if(it != m_neighbours.end())
+                it->second[(v == s) ? t : s] = e;
+            else if(m_hashDegree > 0 && boost::out_degree(v, m_graph) >= m_hashDegree)
+                hashVertex(v);
+        }
+    };
+    
+    void unhashEdge(LocalEdge e) {
+        
+        const LocalVertex s = boost::source(e, m_graph), t = boost::target(e, m_graph);
+        auto it = m_neighbours.find(s);
+        if(it != m_neighbours.end())
+            it->second.erase(t);
+        it = m_neighbours.find(t);
+        if(it != m_neighbours.end())
+            it->second.erase(s);
+    };
+    
+    void unhashVertex(LocalVertex v) {
+        
+        std::pair<local_out_edge_iterator, local_out_edge_iterator> it = boost::out_edges(v, m_graph);
+        for(; it.first != it.second; ++it.first)
+            unhashEdge(*it.first);
+        m_neighbours.erase(v);
+    };
+    
+    void rebuildNeighbourHash() {
+        
+        m_neighbours.clear();
+        if(m_hashDegree == 0)
+            return;
+        
+        std::pair<local_vertex_iterator, local_vertex_iterator> it = boost::vertices(m_graph);
+        for(; it.first != it.second; ++it.first)
+            if(boost::out_degree(*it.first, m_graph) >= m_hashDegree)
+                hashVertex(*it.first);
+    };
+    
 private:
+    void hashVertex(LocalVertex v) {
+        
+        NeighbourMap& map = m_neighbours[v];
+        std::pair<local_out_edge_iterator, local_out_edge_iterator> it = boost::out_edges(v, m_graph);
+        for(; it.first != it.second; ++it.first)
+            map[boost::target(*it.first, m_graph)] = *it.first;
+    };
+    
     Graph& m_graph;
+    std::unordered_map<LocalVertex, NeighbourMap> m_neighbours;
+    std::size_t                                   m_hashDegree = 32;
 
     template<typename functor>
     typename functor::result_type apply_to_bundle(LocalVertex k, functor f);
@@ -1145,6 +1243,19 @@ AccessGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop, graph_base>::
 template< typename edge_prop, typename globaledge_prop, typename vertex_prop, typename cluster_prop, template<class, class, class, class, class> class graph_base>
 std::pair<LocalEdge, bool>
 AccessGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop, graph_base>::edge(LocalVertex source, LocalVertex target) {
+    
+    //the hashed edge may be stored in the other direction, but the descriptor must go from source to target
+    for(LocalVertex v : {source, target}) {
+        auto it = m_neighbours.find(v);
+        if(it == m_neighbours.end())
+            continue;
+        
+        auto edge = it->second.find((v == source) ? target : source);
+        if(edge == it->second.end())
+            return std::make_pair(LocalEdge(), false);
+        
+        return std::make_pair(LocalEdge(source, target, edge->second.get_property()), true);
+    }
     return boost::edge(source, target, m_graph);
 };
 
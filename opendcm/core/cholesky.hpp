@@ -0,0 +1,255 @@
+/*
+    openDCM, dimensional constraint manager
+    Copyright (C) 2015  Stefan Troeger <stefantroeger@gmx.net>
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along
+    with this library; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef DCM_CHOLESKY_H
+#define DCM_CHOLESKY_H
+
+#include <vector>
+#include <atomic>
+#include <algorithm>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+#include "defines.hpp"
+#include "scheduler.hpp"
+#include "ordering.hpp"
+
+namespace dcm {
+namespace numeric {
+
+/**
+ * @brief Parallel supernodal Cholesky factorization for block sparse matrices
+ *
+ * Factorizes symmetric positive definite matrices like the normal equations \f$ J^TJ \f$. The matrix is
+ * described by parameter blocks (e.g. 6 parameters for a cluster, 3 for a point) and the block adjacency
+ * given by the constraint graph. Every block column of the factor is stored as dense panel, hence all
+ * numeric work is done by dense kernels on whole blocks.
+ *
+ * The blocks are eliminated in the given order, use \ref ordering::nestedDissection to get a fill
+ * reducing order with a well balanced elimination tree. Every block column only depends on the columns in
+ * its elimination subtree, therefore independent subtrees are factorized concurrently by the scheduler
+ * (see \ref shedule::for_each_postorder). The factorization is left looking: a column gathers the updates
+ * of all its descendants and writes nothing but its own panel, so no locking is needed.
+ *
+ * The usage follows the Eigen solvers: analyze the structure once, factorize for every new set of values
+ * and solve afterwards.
+ */
+template<typename Kernel>
+class BlockCholesky {
+
+public:
+    typedef typename Kernel::Scalar                               Scalar;
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, 1>              VectorX;
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> MatrixX;
+    typedef Eigen::SparseMatrix<Scalar>                           SparseMatrix;
+
+    bool parallel = true;
+    int  grainsize = 16;    //subtrees with less block columns are factorized sequentially
+
+    /**
+     * @brief Symbolic analysis of the block structure
+     *
+     * Computes the elimination tree and the block structure of the factor.
+     *
+     * @param blockSizes The number of parameters for every block
+     * @param adjacency The coupled blocks for every block, must be symmetric
+     */
+    void analyze(const std::vector<int>& blockSizes, const std::vector<std::vector<int>>& adjacency);
+
+    /**
+     * @brief Numeric factorization
+     *
+     * Only the lower triangular part of the matrix is used. All nonzeros must be part of the analyzed
+     * block structure.
+     *
+     * @param A Symmetric positive definite matrix
+     */
+    void factorize(const SparseMatrix& A);
+
+    /**
+     * @brief Factorizes the (damped) normal equations of a jacobian
+     *
+     * @param J The jacobian, the columns must fit the analyzed blocks
+     * @param damping Value added to the diagonal of \f$ J^TJ \f$
+     */
+    void factorizeNormal(const SparseMatrix& J, Scalar damping = 0) {
+
+        SparseMatrix A = J.transpose()*J;
+        if(damping != 0) {
+            SparseMatrix D(A.rows(), A.cols());
+            D.setIdentity();
+            A += damping*D;
+        }
+        factorize(A);
+    };
+
+    Eigen::ComputationInfo info() const {
+        return m_info;
+    };
+
+    /**
+     * @brief Solves A x = b with the last factorization, b may have multiple columns
+     */
+    MatrixX solve(const MatrixX& b) const;
+
+    VectorX solve(const VectorX& b) const {
+        return solve(MatrixX(b));
+    };
+
+    //the elimination tree of the blocks
+    const std::vector<std::vector<int>>& children() const {
+        return m_children;
+    };
+
+    //the number of nonzero blocks in the factor, including the diagonal ones
+    int factorBlocks() const {
+        int count = 0;
+        for(const std::vector<int>& rows : m_rows)
+            count += rows.size();
+        return count;
+    };
+
+private:
+    int position(int column, int row) const {
+        const std::vector<int>& rows = m_rows[column];
+        auto it = std::lower_bound(rows.begin(), rows.end(), row);
+        dcm_assert(it != rows.end() && *it == row);
+        return it - rows.begin();
+    };
+
+    bool factorizeColumn(int j);
+
+    std::vector<int>                              m_sizes, m_start, m_blockOf, m_roots;
+    std::vector<std::vector<int>>                 m_children, m_rows, m_offsets;
+    std::vector<std::vector<std::pair<int,int>>>  m_updates;   //descendant column and its row position
+    std::vector<MatrixX>                          m_panels;
+    Eigen::ComputationInfo                        m_info = Eigen::InvalidInput;
+};
+
+/**
+ * @brief Domain decomposition solver for single large components
+ *
+ * Splitting into connected or biconnected components does not help for one big loop rich component. This
+ * solver partitions the constraint graph of such a component into balanced subdomains connected only
+ * through a small vertex separator (see \ref ordering::partition). Ordering the separator last gives the
+ * block arrow structure
+ * \f[ \begin{pmatrix} A_{1} & & A_{1s} \\ & \ddots & \vdots \\ A_{s1} & \cdots & A_{s} \end{pmatrix} \f]
+ * where all subdomains are independent. They are factorized (by \ref BlockCholesky with a nested
+ * dissection order) and eliminated concurrently, the remaining dense Schur complement
+ * \f$ S = A_s - \sum_i A_{si}A_i^{-1}A_{is} \f$ of the separator is factorized afterwards.
+ *
+ * The interface is the same as the one of \ref BlockCholesky, but the full symmetric matrix is needed as
+ * the coupling blocks are extracted from it.
+ */
+template<typename Kernel>
+class DomainDecomposition {
+
+public:
+    typedef typename Kernel::Scalar                               Scalar;
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, 1>              VectorX;
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> MatrixX;
+    typedef Eigen::SparseMatrix<Scalar>                           SparseMatrix;
+
+    int  domains = 4;
+    bool parallel = true;
+
+    /**
+     * @brief Partitions the block graph and analyzes the subdomains
+     *
+     * @param blockSizes The number of parameters for every block
+     * @param adjacency The coupled blocks for every block, must be symmetric
+     */
+    void analyze(const std::vector<int>& blockSizes, const std::vector<std::vector<int>>& adjacency);
+
+    /**
+     * @brief Factorizes the subdomains and the separator Schur complement
+     *
+     * @param A Symmetric positive definite matrix, both triangular parts must be given
+     */
+    void factorize(const SparseMatrix& A);
+
+    /**
+     * @brief Factorizes the (damped) normal equations of a jacobian
+     *
+     * @param J The jacobian, the columns must fit the analyzed blocks
+     * @param damping Value added to the diagonal of \f$ J^TJ \f$
+     */
+    void factorizeNormal(const SparseMatrix& J, Scalar damping = 0) {
+
+        SparseMatrix A = J.transpose()*J;
+        if(damping != 0) {
+            SparseMatrix D(A.rows(), A.cols());
+            D.setIdentity();
+            A += damping*D;
+        }
+        factorize(A);
+    };
+
+    Eigen::ComputationInfo info() const {
+        return m_info;
+    };
+
+    /**
+     * @brief Solves A x = b with the last factorization
+     */
+    VectorX solve(const VectorX& b) const;
+
+    //the subdomain of every block, -1 for separator blocks
+    const std::vector<int>& parts() const {
+        return m_part;
+    };
+
+    int separatorSize() const {
+        return m_indices.size() - m_offsets.back();
+    };
+
+private:
+    template<typename Functor>
+    void forEachDomain(const Functor& func) const {
+
+        if(!parallel) {
+            for(int d=0; d<domains; ++d)
+                func(d);
+            return;
+        }
+        std::vector<int> ids(domains);
+        for(int d=0; d<domains; ++d)
+            ids[d] = d;
+        shedule::for_each(ids.begin(), ids.end(), func);
+    };
+
+    std::vector<int>                                  m_part, m_offsets, m_indices;
+    Eigen::PermutationMatrix<Eigen::Dynamic>          m_permutation;
+    std::vector<BlockCholesky<Kernel>>                m_solver;
+    std::vector<SparseMatrix>                         m_block;      //subdomain to separator coupling
+    std::vector<MatrixX>                              m_coupling;   //A_i^{-1} A_is
+    std::vector<MatrixX>                              m_schur;
+    Eigen::LLT<MatrixX>                               m_separator;
+    Eigen::ComputationInfo                            m_info = Eigen::InvalidInput;
+};
+
+}//numeric
+}//dcm
+
+#ifndef DCM_EXTERNAL_CORE
+#include "imp/cholesky_imp.hpp"
+#endif
+
+#endif //DCM_CHOLESKY_H
@@ -20,6 +20,9 @@
 #ifndef DCM_CLUSTERGRAPH_HPP
 #define DCM_CLUSTERGRAPH_HPP
 
+#include <vector>
+#include <algorithm>
+
 #include "accessgraph.hpp"
 
 namespace mpl = boost::mpl;
@@ -91,8 +94,9 @@ struct IDgen {
  **/
 typedef std::shared_ptr<IDgen> IDpointer;
 
+//the global edge list is pooled too, so that all nodes of the graph are kept together
 template<typename T1, typename T2, typename T3, typename T4, typename T5>
-using adjacency_list = boost::adjacency_list<T1,T2,T3,T4,T5>;
+using adjacency_list = boost::adjacency_list<T1,T2,T3,T4,T5,boost::no_property,pool_listS>;
 
 /**
  * @ingroup ClusterGraph
@@ -115,7 +119,8 @@ class ClusterGraph : public AccessGraph<edge_prop, globaledge_prop,
     typedef AccessGraph<edge_prop, globaledge_prop, 
                         vertex_prop, cluster_prop, adjacency_list> Base;
                                                 
-    typedef std::map<LocalVertex, std::shared_ptr<ClusterGraph> > ClusterMap;
+    //flat storage of all subclusters, the vertex bundles point directly to their cluster
+    typedef std::vector<std::pair<LocalVertex, std::shared_ptr<ClusterGraph> > > ClusterMap;
     
 public:
     typedef typename Base::Graph Graph;
@@ -445,6 +450,16 @@ private:
 
     void simpleRemoveEdge(LocalEdge e);
 
+    //structure changes which keep the neighbour hash of the access graph up to date. Every change of
+    //the graph structure must use those instead of the boost functions
+    std::pair<LocalEdge, bool> getOrAddEdge(LocalVertex source, LocalVertex target);
+    void removeLocalEdge(LocalEdge e);
+    void removeLocalVertex(LocalVertex v);
+
+    //subcluster bookkeeping which keeps the flat subcluster storage and the vertex bundle pointer in sync
+    void setSubcluster(LocalVertex v, std::shared_ptr<ClusterGraph> g);
+    std::shared_ptr<ClusterGraph> releaseSubcluster(LocalVertex v);
+
 
 public:
     /**
@@ -664,6 +679,7 @@ void ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::copyIn
     vertex_copier<Graph> vc(m_graph, *into);
     edge_copier<Graph> ec(m_graph, *into);
     boost::copy_graph(m_graph, *into, boost::vertex_index_map(propmapIndex).vertex_copy(vc).edge_copy(ec));
+    into->rebuildNeighbourHash();
 
     //set the IDgen to the same value to avoid duplicate id's in the copied cluster
     into->m_id->setCount(m_id->count());
@@ -679,8 +695,8 @@ void ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::copyIn
         GlobalVertex gv = Base::getGlobalVertex((*it.first).first);
         LocalVertex  lv = into->getLocalVertex(gv).first;
 
-        //add the new graph to the subclustermap
-        into->m_clusters[lv] = ng;
+        //add the new graph to the subclusters
+        into->setSubcluster(lv, ng);
 
         //copy the subcluster
         (*it.first).second->copyInto(ng, functor);
@@ -707,7 +723,9 @@ std::pair<std::shared_ptr< ClusterGraph<edge_prop, globaledge_prop, vertex_prop,
     vp.template setProperty<VertexProperty>(m_id->generate());
     LocalVertex v = boost::add_vertex(vp, m_graph);
     std::shared_ptr<ClusterGraph> sp = std::static_pointer_cast<ClusterGraph>(sp_base::shared_from_this());
-    return std::pair<std::shared_ptr<ClusterGraph>, LocalVertex> (m_clusters[v] = std::shared_ptr<ClusterGraph> (new ClusterGraph(sp)), v);
+    std::shared_ptr<ClusterGraph> cg(new ClusterGraph(sp));
+    setSubcluster(v, cg);
+    return std::make_pair(cg, v);
 };
 
 template< typename edge_prop, typename globaledge_prop, typename vertex_prop, typename cluster_prop>
@@ -760,14 +778,15 @@ ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::numClusters
 
 template< typename edge_prop, typename globaledge_prop, typename vertex_prop, typename cluster_prop>
 bool ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::isCluster(const LocalVertex v) const {
-    return (m_clusters.find(v) != m_clusters.end());
+    return m_graph[v].template getProperty<Subcluster>() != nullptr;
 };
 
 template< typename edge_prop, typename globaledge_prop, typename vertex_prop, typename cluster_prop>
 std::shared_ptr< ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop> >
 ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::getVertexCluster(LocalVertex v) {
-    if(isCluster(v))
-        return m_clusters[v];
+    AccessGraphBase* cluster = m_graph[v].template getProperty<Subcluster>();
+    if(cluster)
+        return std::static_pointer_cast<ClusterGraph>(static_cast<ClusterGraph*>(cluster)->shared_from_this());
 
     //TODO:throw if not a cluster
     return std::shared_ptr< ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop> >();//sp_base::shared_from_this();
@@ -799,6 +818,9 @@ void ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::remove
 
 template< typename edge_prop, typename globaledge_prop, typename vertex_prop, typename cluster_prop>
 void ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::clearClusters() {
+    for(auto& c : m_clusters)
+        m_graph[c.first].template setProperty<Subcluster>(nullptr);
+    
     m_clusters.clear();
 };
 
@@ -806,21 +828,18 @@ template< typename edge_prop, typename globaledge_prop, typename vertex_prop, ty
 template<typename Functor>
 void ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::removeCluster(LocalVertex v, Functor& f) {
 
-    typename ClusterMap::iterator it = m_clusters.find(v);
-
-    if(it == m_clusters.end())
+    if(!isCluster(v))
         throw graph::cluster_error() <<  boost::errinfo_errno(11) << error_message("Cluster is not part of this graph");
 
-    std::pair<LocalVertex, std::shared_ptr<ClusterGraph> > res = *it;
+    std::shared_ptr<ClusterGraph> cluster = getVertexCluster(v);
 
     //apply functor to all vertices and edges in the subclusters
-    f(res.second);
-    res.second->remove_vertices(f, true);
+    f(cluster);
+    cluster->remove_vertices(f, true);
 
-    //remove from map, delete subcluster and remove vertex
-    m_clusters.erase(v);
-    boost::clear_vertex(v, m_graph);    //should not be needed, just to ensure it
-    boost::remove_vertex(v, m_graph);
+    //remove from subclusters, delete subcluster and remove vertex
+    releaseSubcluster(v);
+    removeLocalVertex(v);
 };
 
 template< typename edge_prop, typename globaledge_prop, typename vertex_prop, typename cluster_prop>
@@ -900,11 +919,7 @@ ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::addEdge(Loc
 
     LocalEdge e;
     bool done;
-    boost::tie(e, done) = boost::edge(source, target, m_graph);
-
-    //if done=true the edge alredy existed
-    if(!done)
-        boost::tie(e, done) = boost::add_edge(source, target, m_graph);
+    boost::tie(e, done) = getOrAddEdge(source, target);
 
     if(!done)
         return fusion::make_vector(LocalEdge(), GlobalEdge(), false);
@@ -942,11 +957,8 @@ ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::addEdge(Glo
         return res;
     }
 
-    //check if we already have that Local edge
-    boost::tie(e, d3) = boost::edge(v1, v2, m_graph);
-
-    if(!d3)
-        boost::tie(e, d3) = boost::add_edge(v1, v2, m_graph);
+    //check if we already have that Local edge or create it
+    boost::tie(e, d3) = getOrAddEdge(v1, v2);
 
     if(!d3)
         return fusion::make_vector(LocalEdge(), GlobalEdge(), false, false);
@@ -1009,10 +1021,8 @@ void ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::downst
     std::for_each(re.begin(), re.end(), boost::bind(&ClusterGraph::simpleRemoveEdge, this, _1));
 
     //if we have the real vertex here and not only a containing cluster we can delete it
-    if(!isCluster(res.first)) {
-        boost::clear_vertex(res.first, m_graph);    //just to make sure, should be done already
-        boost::remove_vertex(res.first, m_graph);
-    };
+    if(!isCluster(res.first))
+        removeLocalVertex(res.first);
 
     //lets go downstream
     for(cluster_iterator it = m_clusters.begin(); it != m_clusters.end(); it++)
@@ -1021,9 +1031,58 @@ void ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::downst
 
 template< typename edge_prop, typename globaledge_prop, typename vertex_prop, typename cluster_prop>
 void ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::simpleRemoveEdge(LocalEdge e) {
+    removeLocalEdge(e);
+};
+
+template< typename edge_prop, typename globaledge_prop, typename vertex_prop, typename cluster_prop>
+std::pair<LocalEdge, bool>
+ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::getOrAddEdge(LocalVertex source, LocalVertex target) {
+
+    std::pair<LocalEdge, bool> res = Base::edge(source, target);
+    if(res.second)
+        return res;
+
+    res = boost::add_edge(source, target, m_graph);
+    if(res.second)
+        Base::hashEdge(res.first);
+
+    return res;
+};
+
+template< typename edge_prop, typename globaledge_prop, typename vertex_prop, typename cluster_prop>
+void ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::removeLocalEdge(LocalEdge e) {
+    Base::unhashEdge(e);
     boost::remove_edge(e, m_graph);
 };
 
+template< typename edge_prop, typename globaledge_prop, typename vertex_prop, typename cluster_prop>
+void ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::removeLocalVertex(LocalVertex v) {
+    Base::unhashVertex(v);
+    boost::clear_vertex(v, m_graph);
+    boost::remove_vertex(v, m_graph);
+};
+
+template< typename edge_prop, typename globaledge_prop, typename vertex_prop, typename cluster_prop>
+void ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::setSubcluster(LocalVertex v, std::shared_ptr<ClusterGraph> g) {
+    m_clusters.push_back(std::make_pair(v, g));
+    m_graph[v].template setProperty<Subcluster>(g.get());
+};
+
+template< typename edge_prop, typename globaledge_prop, typename vertex_prop, typename cluster_prop>
+std::shared_ptr< ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop> >
+ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::releaseSubcluster(LocalVertex v) {
+
+    std::shared_ptr<ClusterGraph> g;
+    auto it = std::find_if(m_clusters.begin(), m_clusters.end(), 
+                           [&](const typename ClusterMap::value_type& c) {return c.first == v;});
+    if(it != m_clusters.end()) {
+        g = it->second;
+        m_clusters.erase(it);
+    }
+    m_graph[v].template setProperty<Subcluster>(nullptr);
+    return g;
+};
+
 template< typename edge_prop, typename globaledge_prop, typename vertex_prop, typename cluster_prop>
 template<typename Functor>
 void ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::removeVertex(LocalVertex id, Functor& f) {
@@ -1065,7 +1124,7 @@ void ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::remove
     ((*fusion::at_c<1> (res)) [fusion::at_c<0> (res)]).template markPropertyChanged<GEdgeProperty>();
     
     if(vec.empty())
-        boost::remove_edge(fusion::at_c<0> (res), fusion::at_c<1> (res)->getDirectAccess());    
+        fusion::at_c<1> (res)->removeLocalEdge(fusion::at_c<0> (res));
     
 };
 
@@ -1076,7 +1135,7 @@ void ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::remove
     auto& vec = m_graph[id].template getPropertyAccessible<GEdgeProperty>();
     std::for_each(vec.begin(), vec.end(), boost::bind<void> (boost::ref(apply_remove_prediacte<placehoder, ClusterGraph> (f, -1)), _1));
     m_graph[id].template markPropertyChanged<GEdgeProperty>();
-    boost::remove_edge(id, m_graph);
+    removeLocalEdge(id);
 };
 
 template< typename edge_prop, typename globaledge_prop, typename vertex_prop, typename cluster_prop>
@@ -1115,10 +1174,7 @@ ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::moveToSubcl
             //get or create the edge between the old edge target and the cluster
             LocalEdge e;
             bool done;
-            boost::tie(e, done) = boost::edge(target, Cluster, m_graph);
-
-            if(!done)
-                boost::tie(e, done) = boost::add_edge(target, Cluster, m_graph);
+            boost::tie(e, done) = getOrAddEdge(target, Cluster);
 
             //if(!done) TODO: throw
 
@@ -1136,12 +1192,12 @@ ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::moveToSubcl
     //resort cluster parentship if needed
     if(isCluster(v)) {
 
-        cg->m_clusters[nv] = m_clusters[v];
-        cg->m_clusters[nv]->m_parent = cg;
-        m_clusters.erase(v);
+        std::shared_ptr<ClusterGraph> sub = releaseSubcluster(v);
+        sub->m_parent = cg;
+        cg->setSubcluster(nv, sub);
     }
 
-    std::pair<LocalEdge, bool> moveedge = boost::edge(v, Cluster, m_graph);
+    std::pair<LocalEdge, bool> moveedge = Base::edge(v, Cluster);
 
     if(moveedge.second) {
         auto& vec = m_graph[moveedge.first].template getPropertyAccessible<GEdgeProperty>();
@@ -1160,10 +1216,7 @@ ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::moveToSubcl
             //get or create the edge between the new vertex and the target
             LocalEdge e;
             bool done;
-            boost::tie(e, done) = boost::edge(nv, res.first, cg->getDirectAccess());
-
-            if(!done)
-                boost::tie(e, done) = boost::add_edge(nv, res.first, cg->getDirectAccess());
+            boost::tie(e, done) = cg->getOrAddEdge(nv, res.first);
 
             //if(!done) TODO: throw
 
@@ -1176,8 +1229,7 @@ ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::moveToSubcl
 
     //all global edges concerning the move vertex are processed and it is moved to the subcluster,
     //lets destroy it in the local cluster
-    boost::clear_vertex(v, m_graph);
-    boost::remove_vertex(v, m_graph);
+    removeLocalVertex(v);
 
     return nv;
 };
@@ -1194,9 +1246,9 @@ ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::moveToParen
 
     //regrouping if needed
     if(isCluster(v)) {
-        parent()->m_clusters[nv] = m_clusters[v];
-        parent()->m_clusters[nv]->m_parent = m_parent;
-        m_clusters.erase(v);
+        std::shared_ptr<ClusterGraph> sub = releaseSubcluster(v);
+        sub->m_parent = m_parent;
+        parent()->setSubcluster(nv, sub);
     }
 
     GlobalVertex gv = vb.template getProperty<VertexProperty>();
@@ -1232,10 +1284,7 @@ ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::moveToParen
             //get or create the edge between the new vertex and the target
             LocalEdge e;
             bool done;
-            boost::tie(e, done) = boost::edge(nv, res.first, parent()->getDirectAccess());
-
-            if(!done)
-                boost::tie(e, done) = boost::add_edge(nv, res.first, parent()->getDirectAccess());
+            boost::tie(e, done) = parent()->getOrAddEdge(nv, res.first);
 
             //if(!done) TODO: throw
 
@@ -1257,7 +1306,7 @@ ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::moveToParen
     LocalEdge e;
 
     if(it.first != it.second)
-        e = boost::add_edge(nv, this_v, parent()->getDirectAccess()).first;
+        e = parent()->getOrAddEdge(nv, this_v).first;
 
     for(; it.first != it.second; it.first++) {
         auto& ep  = m_graph[*it.first].template getPropertyAccessible<GEdgeProperty>();
@@ -1269,12 +1318,11 @@ ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::moveToParen
 
     //all global edges concerning the move vertex are processed and it is moved to the parent,
     //lets destroy it in the local cluster
-    boost::clear_vertex(v, m_graph);
-    boost::remove_vertex(v, m_graph);
+    removeLocalVertex(v);
 
     //it's possible that some local edges in the parent are empty now, let's destroy them
     for(std::vector<LocalEdge>::iterator it = edge_vec.begin(); it != edge_vec.end(); it++)
-        boost::remove_edge(*it, parent()->getDirectAccess());
+        parent()->removeLocalEdge(*it);
 
     return nv;
 };
@@ -1316,7 +1364,7 @@ ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::getContaini
         return fusion::make_vector(LocalVertex(), std::shared_ptr<ClusterGraph>(), false);
 
     if(isCluster(v) && (Base::getGlobalVertex(v) != id))
-        return m_clusters[v]->getContainingVertexGraph(id);
+        return getVertexCluster(v)->getContainingVertexGraph(id);
     else
         return fusion::make_vector(v, sp_base::shared_from_this(), true);
 };
@@ -1333,7 +1381,7 @@ ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::getContaini
     if(!((d1 && d2) && (v1 != v2)))
         return std::make_pair(LocalEdge(), false);
 
-    return boost::edge(v1, v2, m_graph);
+    return Base::edge(v1, v2);
 };
 
 template< typename edge_prop, typename globaledge_prop, typename vertex_prop, typename cluster_prop>
@@ -1349,10 +1397,10 @@ ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop>::getContaini
         return fusion::make_vector(LocalEdge(), std::shared_ptr< ClusterGraph<edge_prop, globaledge_prop, vertex_prop, cluster_prop> >(), false);
 
     if(v1 == v2)
-        return m_clusters[v1]->getContainingEdgeGraph(id);
+        return getVertexCluster(v1)->getContainingEdgeGraph(id);
 
     std::shared_ptr<ClusterGraph> sp = std::static_pointer_cast<ClusterGraph>(sp_base::shared_from_this());
-    return fusion::make_vector(boost::edge(v1, v2, m_graph).first, sp, true);
+    return fusion::make_vector(Base::edge(v1, v2).first, sp, true);
 };
 
 } //namespace graph
@@ -220,6 +220,49 @@ struct ConstraintProperty {
     
 namespace numeric {
    
+/**
+ * @brief Intermediate values shared by all constraints of a geometry pair
+ * 
+ * Multiple constraints between the same two geometries often need the same intermediate values, e.g. 
+ * direction norms, dot and cross products. Specialisations of this struct hold those values for a 
+ * geometry combination and calculate them in \ref update. A \ref FusedConstraintEquation updates them 
+ * once per evaluation for all its constraints. The default has no shared values.
+ */
+template<typename Kernel, typename PG1, typename PG2>
+struct SharedTerms {
+    void update(PG1& g1, PG2& g2) {};
+};
+
+/**
+ * @brief Access to the \ref SharedTerms of a constraint
+ * 
+ * Constraint specialisations use \ref terms to get the values. If a fused equation shares its terms they
+ * are used directly, otherwise they are calculated for the given geometries. Shared terms are only valid 
+ * for the input geometries of the fused equation.
+ */
+template<typename Kernel, typename PG1, typename PG2>
+struct SharedTermsUser {
+    
+    typedef SharedTerms<Kernel, PG1, PG2> Terms;
+    
+    void shareTerms(const Terms* terms) {
+        m_shared = terms;
+    };
+    
+protected:
+    const Terms& terms(PG1& g1, PG2& g2) {
+        if(m_shared)
+            return *m_shared;
+        
+        m_terms.update(g1, g2);
+        return m_terms;
+    };
+    
+private:
+    const Terms* m_shared = nullptr;
+    Terms        m_terms;
+};
+
 /**
  * @brief Base class to unify derivation of parent classes
  * 
@@ -230,6 +273,7 @@ namespace numeric {
  */
 template<typename Kernel, typename PC, typename PG1, typename PG2>
 struct ConstraintBase : public BinaryEquation<Kernel, PG1, PG2, typename Kernel::Scalar>, 
+                        public SharedTermsUser<Kernel, PG1, PG2>,
                         public PC  {
     
         typedef BinaryEquation<Kernel, PG1, PG2, typename Kernel::Scalar> Equation;
@@ -246,6 +290,12 @@ struct ConstraintBase : public BinaryEquation<Kernel, PG1, PG2, typename Kernel:
         void assign(const PC& pc) {
             operator=(pc);
         };
+        
+        //Called once on initialisation if the first or second input is fixed. Specialisations can hide 
+        //those to precalculate values which only depend on the fixed geometry, e.g. normalized directions, 
+        //instead of recalculating them in every evaluation.
+        void prepareFixedFirst(Geometry1& g1) {};
+        void prepareFixedSecond(Geometry2& g2) {};
 };
     
 /**
@@ -359,12 +409,20 @@ struct ConstraintEquationBase : public numeric::Constraint<Kernel, PC, PG1, PG2>
     virtual void init(LinearSystem<Kernel>& sys) {
 #ifdef DCM_DEBUG
         dcm_assert(!m_init);
-        dcm_assert(Inherited::firstInputEquation() && Inherited::firstInputEquation()->isInitialized());
-        dcm_assert(Inherited::secondInputEquation() && Inherited::secondInputEquation()->isInitialized());
+        //fixed inputs have no parameters and are therefore never initialized
+        dcm_assert(Inherited::firstInputEquation() && (Inherited::firstInputEquation()->isInitialized()
+                   || Inherited::firstInputEquation()->getComplexity() == Complexity::Fixed));
+        dcm_assert(Inherited::secondInputEquation() && (Inherited::secondInputEquation()->isInitialized()
+                   || Inherited::secondInputEquation()->getComplexity() == Complexity::Fixed));
         m_init = true;
 #endif
+        m_evaluation = &sys.evaluation();
+        
         //setup the residual first to see in which row we are working with this constraint
         residual = sys.mapResidual();
+        sys.setResidualWeight(residual.Index, m_weight, m_priority);
+        if(m_loss != Loss::Squared)
+            sys.setResidualLoss(residual.Index, m_loss, m_lossScale);
             
         //Setup the correct jacobi entry for the individual parameter
         for(auto& der : Inherited::firstInputEquation()->derivatives())  
@@ -374,6 +432,40 @@ struct ConstraintEquationBase : public numeric::Constraint<Kernel, PC, PG1, PG2>
             g2_derivatives.push_back({&der.first, sys.mapJacobi(residual.Index, der.second.Index)});
     };
     
+    /**
+     * @brief Make the constraint a soft one
+     * 
+     * Soft constraints are only minimized in the weighted least squares sense, without disturbing the
+     * hard constraints and the soft ones with a lower priority number. Priority 0 makes the constraint
+     * hard again, which is the default. Must be called before \ref init.
+     * 
+     * @param weight Factor for the squared residual of this constraint
+     * @param priority Importance level, 0 for hard constraints
+     */
+    void setWeight(typename Kernel::Scalar weight, int priority = 1) {
+        m_weight   = weight;
+        m_priority = priority;
+    };
+    
+    /**
+     * @brief Use a robust loss for this constraints residual
+     * 
+     * Useful for constraints created from measured data, where outliers are expected. Residuals bigger 
+     * than \a scale get a reduced influence on the solution. Must be called before \ref init.
+     */
+    void setLoss(Loss loss, typename Kernel::Scalar scale) {
+        m_loss      = loss;
+        m_lossScale = scale;
+    };
+    
+    typename Kernel::Scalar getWeight() {
+        return m_weight;
+    };
+    
+    int getPriority() {
+        return m_priority;
+    };
+    
 #ifdef DCM_TESTING
     typename Kernel::Scalar getResidual() {
         return *residual.Value;
@@ -390,6 +482,15 @@ struct ConstraintEquationBase : public numeric::Constraint<Kernel, PC, PG1, PG2>
     
 protected:
     
+    //the parts of the equation requested by the system evaluation mode
+    bool residualRequested() {
+        return !m_evaluation || *m_evaluation != Evaluation::Derivatives;
+    };
+    
+    bool derivativesRequested() {
+        return !m_evaluation || *m_evaluation != Evaluation::Residuals;
+    };
+    
     void firstAsSimplified() {
          
         auto result1 = Inherited::calculateGradientFirstComplete(Inherited::firstInput(), 
@@ -432,9 +533,13 @@ protected:
     bool m_init = false;
 #endif
     Residual                        residual;
+    typename Kernel::Scalar         m_weight    = 1;
+    int                             m_priority  = 0;
+    Loss                            m_loss      = Loss::Squared;
+    typename Kernel::Scalar         m_lossScale = 1;
     std::vector<Derivative1Pack>    g1_derivatives;
     std::vector<Derivative2Pack>    g2_derivatives;
-    
+    const Evaluation*               m_evaluation = nullptr;
 };
 
 /**
@@ -450,7 +555,10 @@ struct ConstraintSimplifiedEquation : public ConstraintEquationBase<Kernel, PC,
     typedef ConstraintEquationBase<Kernel, PC, PG1, PG2> Inherited;
     
     CALCULATE() {
-        *Inherited::residual.Value = Inherited::calculateError(Inherited::firstInput(), Inherited::secondInput());
+        if(Inherited::residualRequested())
+            *Inherited::residual.Value = Inherited::calculateError(Inherited::firstInput(), Inherited::secondInput());
+        if(!Inherited::derivativesRequested())
+            return;
         Inherited::firstAsSimplified();
         Inherited::secondAsSimplified();
     };
@@ -469,7 +577,10 @@ struct ConstraintComplexEquation : ConstraintEquationBase<Kernel, PC, PG1, PG2>
     typedef ConstraintEquationBase<Kernel, PC, PG1, PG2> Inherited;
     
     CALCULATE() {
-        *Inherited::residual.Value = Inherited::calculateError(Inherited::firstInput(), Inherited::secondInput());
+        if(Inherited::residualRequested())
+            *Inherited::residual.Value = Inherited::calculateError(Inherited::firstInput(), Inherited::secondInput());
+        if(!Inherited::derivativesRequested())
+            return;
         Inherited::firstAsComplex();
         Inherited::secondAsComplex();
     };
@@ -488,7 +599,10 @@ struct ConstraintSimplifiedComplexEquation : ConstraintEquationBase<Kernel, PC,
     typedef ConstraintEquationBase<Kernel, PC, PG1, PG2> Inherited;
     
     CALCULATE() {
-        *Inherited::residual.Value = Inherited::calculateError(Inherited::firstInput(), Inherited::secondInput());
+        if(Inherited::residualRequested())
+            *Inherited::residual.Value = Inherited::calculateError(Inherited::firstInput(), Inherited::secondInput());
+        if(!Inherited::derivativesRequested())
+            return;
         Inherited::firstAsSimplified();
         Inherited::secondAsComplex();
     };
@@ -507,12 +621,129 @@ struct ConstraintComplexSimplifiedEquation : ConstraintEquationBase<Kernel, PC,
     typedef ConstraintEquationBase<Kernel, PC, PG1, PG2> Inherited;
    
     CALCULATE() {
-        *Inherited::residual.Value = Inherited::calculateError(Inherited::firstInput(), Inherited::secondInput());
+        if(Inherited::residualRequested())
+            *Inherited::residual.Value = Inherited::calculateError(Inherited::firstInput(), Inherited::secondInput());
+        if(!Inherited::derivativesRequested())
+            return;
         Inherited::firstAsComplex();
         Inherited::secondAsSimplified();
     };
 };
 
+/**
+ * @brief Error function evaluation with a fixed first input
+ * 
+ * If the first input equation is fixed, e.g. a reference geometry, it does not have any derivatives
+ * and the constraint is effectively unary. Only the gradient of the free second input is calculated, 
+ * everything depending on the fixed input alone is prepared once on initialisation.
+ * 
+ * \tparam Complex true if the second input is a complex equation
+ */
+template<typename Kernel, typename PC, typename PG1, typename PG2, bool Complex>
+struct ConstraintFixedFirstEquation : ConstraintEquationBase<Kernel, PC, PG1, PG2> {
+    
+    typedef ConstraintEquationBase<Kernel, PC, PG1, PG2> Inherited;
+    
+    virtual void init(LinearSystem<Kernel>& sys) override {
+        dcm_assert(Inherited::firstInputEquation()->getComplexity() == Complexity::Fixed);
+        Inherited::init(sys);
+        Inherited::prepareFixedFirst(Inherited::firstInput());
+    };
+    
+    CALCULATE() {
+        if(Inherited::residualRequested())
+            *Inherited::residual.Value = Inherited::calculateError(Inherited::firstInput(), Inherited::secondInput());
+        if(!Inherited::derivativesRequested())
+            return;
+        if(Complex)
+            Inherited::secondAsComplex();
+        else 
+            Inherited::secondAsSimplified();
+    };
+};
+
+/**
+ * @brief Error function evaluation with a fixed second input
+ * 
+ * The counterpart of \ref ConstraintFixedFirstEquation for a fixed second input.
+ * 
+ * \tparam Complex true if the first input is a complex equation
+ */
+template<typename Kernel, typename PC, typename PG1, typename PG2, bool Complex>
+struct ConstraintFixedSecondEquation : ConstraintEquationBase<Kernel, PC, PG1, PG2> {
+    
+    typedef ConstraintEquationBase<Kernel, PC, PG1, PG2> Inherited;
+    
+    virtual void init(LinearSystem<Kernel>& sys) override {
+        dcm_assert(Inherited::secondInputEquation()->getComplexity() == Complexity::Fixed);
+        Inherited::init(sys);
+        Inherited::prepareFixedSecond(Inherited::secondInput());
+    };
+    
+    CALCULATE() {
+        if(Inherited::residualRequested())
+            *Inherited::residual.Value = Inherited::calculateError(Inherited::firstInput(), Inherited::secondInput());
+        if(!Inherited::derivativesRequested())
+            return;
+        if(Complex)
+            Inherited::firstAsComplex();
+        else 
+            Inherited::firstAsSimplified();
+    };
+};
+
+/**
+ * @brief Evaluation of all constraints between a geometry pair in one pass
+ * 
+ * An edge often holds multiple constraints between the same two geometries. Instead of evaluating them 
+ * individually this equation updates the \ref SharedTerms of the geometry pair once and calculates all
+ * constraints afterwards, which then reuse the shared values. 
+ */
+template<typename Kernel, typename PG1, typename PG2>
+struct FusedConstraintEquation : public Calculatable<Kernel> {
+    
+    typedef std::shared_ptr<Calculatable<Kernel>>   Equation;
+    typedef SharedTermsUser<Kernel, PG1, PG2>       User;
+    
+    FusedConstraintEquation(std::shared_ptr<numeric::Equation<Kernel, PG1>> g1, 
+                            std::shared_ptr<numeric::Equation<Kernel, PG2>> g2) 
+        : m_input1(g1), m_input2(g2) {};
+    
+    /**
+     * @brief Add a constraint equation between the fused inputs
+     * 
+     * The equation must be a constraint between the inputs given on construction, as it will use their
+     * shared values from now on.
+     */
+    void add(Equation eqn) {
+        User* user = dynamic_cast<User*>(eqn.get());
+        dcm_assert(user);
+        user->shareTerms(&m_terms);
+        m_equations.push_back(eqn);
+    };
+    
+    const std::vector<Equation>& equations() {
+        return m_equations;
+    };
+    
+    virtual void init(LinearSystem<Kernel>& sys) override {
+        for(auto& eqn : m_equations)
+            eqn->init(sys);
+    };
+    
+    CALCULATE() {
+        m_terms.update(m_input1->output(), m_input2->output());
+        for(auto& eqn : m_equations)
+            eqn->execute();
+    };
+    
+private:
+    std::shared_ptr<numeric::Equation<Kernel, PG1>> m_input1;
+    std::shared_ptr<numeric::Equation<Kernel, PG2>> m_input2;
+    SharedTerms<Kernel, PG1, PG2>                   m_terms;
+    std::vector<Equation>                           m_equations;
+};
+
 template<typename Kernel>
 struct ConstraintEquationGenerator {
     
@@ -522,6 +753,12 @@ struct ConstraintEquationGenerator {
      virtual Equation buildEquation(Equation g1, 
                                     Equation g2, 
                                     symbolic::Constraint* c) const = 0;
+     
+     //fuses the given constraint equations between g1 and g2, which must have the geometry types of this 
+     //generator, into a single equation
+     virtual Equation buildFusedEquation(Equation g1, 
+                                         Equation g2, 
+                                         const std::vector<Equation>& equations) const = 0;
                                               
     virtual std::pair<Equation, FlowNode>
     buildEquationNode(Equation g1, 
@@ -545,7 +782,20 @@ struct TypedConstraintEquationGenerator : public ConstraintEquationGenerator<Ker
         auto tg2 = std::static_pointer_cast<numeric::Equation<Kernel, PG2>>(g2);
         auto& pc  = static_cast<symbolic::TypeConstraint<PC>*>(c)->getPrimitiveConstraint();
         
-        if(tg1->getComplexity() != Complexity::Complex && tg2->getComplexity() != Complexity::Complex) {
+        //constraints between fixed inputs are constant and folded out of the system
+        if(tg1->getComplexity() == Complexity::Fixed && tg2->getComplexity() == Complexity::Fixed)
+            return Equation();
+        else if(tg1->getComplexity() == Complexity::Fixed) {
+            if(tg2->getComplexity() == Complexity::Complex)
+                return create<ConstraintFixedFirstEquation<Kernel, PC, PG1, PG2, true>>(tg1, tg2, pc);
+            return create<ConstraintFixedFirstEquation<Kernel, PC, PG1, PG2, false>>(tg1, tg2, pc);
+        }
+        else if(tg2->getComplexity() == Complexity::Fixed) {
+            if(tg1->getComplexity() == Complexity::Complex)
+                return create<ConstraintFixedSecondEquation<Kernel, PC, PG1, PG2, true>>(tg1, tg2, pc);
+            return create<ConstraintFixedSecondEquation<Kernel, PC, PG1, PG2, false>>(tg1, tg2, pc);
+        }
+        else if(tg1->getComplexity() != Complexity::Complex && tg2->getComplexity() != Complexity::Complex) {
             auto equation = std::make_shared<ConstraintSimplifiedEquation<Kernel, PC, PG1, PG2>>(); 
             equation->setInputEquations(tg1, tg2);
             equation->assign(pc);            
@@ -573,6 +823,19 @@ struct TypedConstraintEquationGenerator : public ConstraintEquationGenerator<Ker
         return Equation();
     };
     
+    virtual Equation buildFusedEquation(Equation g1, Equation g2, 
+                                        const std::vector<Equation>& equations) const override {
+        
+        auto tg1 = std::static_pointer_cast<numeric::Equation<Kernel, PG1>>(g1);
+        auto tg2 = std::static_pointer_cast<numeric::Equation<Kernel, PG2>>(g2);
+        
+        auto fused = std::make_shared<FusedConstraintEquation<Kernel, PG1, PG2>>(tg1, tg2);
+        for(auto& eqn : equations)
+            fused->add(eqn);
+        
+        return fused;
+    };
+    
     virtual std::pair<Equation, FlowNode>
     buildEquationNode(Equation g1, Equation g2, symbolic::Constraint* c,
                       shedule::FlowGraph& flowgraph) const override {
@@ -581,7 +844,21 @@ struct TypedConstraintEquationGenerator : public ConstraintEquationGenerator<Ker
         auto  tg2 = std::static_pointer_cast<numeric::Equation<Kernel, PG2>>(g2);
         auto& pc  = static_cast<symbolic::TypeConstraint<PC>*>(c)->getPrimitiveConstraint();
         
-        if(tg1->getComplexity() != Complexity::Complex && tg2->getComplexity() != Complexity::Complex) {
+        //a folded constraint has no equation, but the node is kept to not break the flow graph
+        if(tg1->getComplexity() == Complexity::Fixed && tg2->getComplexity() == Complexity::Fixed) {
+            return std::make_pair(Equation(), flowgraph.newActionNode([](const shedule::FlowGraph::ContinueMessage& m){}));
+        }
+        else if(tg1->getComplexity() == Complexity::Fixed) {
+            if(tg2->getComplexity() == Complexity::Complex)
+                return createNode(create<ConstraintFixedFirstEquation<Kernel, PC, PG1, PG2, true>>(tg1, tg2, pc), flowgraph);
+            return createNode(create<ConstraintFixedFirstEquation<Kernel, PC, PG1, PG2, false>>(tg1, tg2, pc), flowgraph);
+        }
+        else if(tg2->getComplexity() == Complexity::Fixed) {
+            if(tg1->getComplexity() == Complexity::Complex)
+                return createNode(create<ConstraintFixedSecondEquation<Kernel, PC, PG1, PG2, true>>(tg1, tg2, pc), flowgraph);
+            return createNode(create<ConstraintFixedSecondEquation<Kernel, PC, PG1, PG2, false>>(tg1, tg2, pc), flowgraph);
+        }
+        else if(tg1->getComplexity() != Complexity::Complex && tg2->getComplexity() != Complexity::Complex) {
             auto equation = std::make_shared<ConstraintSimplifiedEquation<Kernel, PC, PG1, PG2>>(); 
             equation->setInputEquations(tg1, tg2);            
             equation->assign(pc);
@@ -614,6 +891,22 @@ struct TypedConstraintEquationGenerator : public ConstraintEquationGenerator<Ker
             }));
         }
     };
+    
+private:
+    template<typename Eqn, typename Input1, typename Input2>
+    static std::shared_ptr<Eqn> create(Input1 tg1, Input2 tg2, PC& pc) {
+        auto equation = std::make_shared<Eqn>();
+        equation->setInputEquations(tg1, tg2);
+        equation->assign(pc);
+        return equation;
+    };
+    
+    template<typename Eqn>
+    static std::pair<Equation, FlowNode> createNode(std::shared_ptr<Eqn> equation, shedule::FlowGraph& flowgraph) {
+        return std::make_pair(equation, flowgraph.newActionNode([=](const shedule::FlowGraph::ContinueMessage& m){
+            equation->calculate();
+        }));
+    };
 };
 
 }//numeric
@@ -20,7 +20,7 @@
 #ifndef FILTERGRAPH_HPP
 #define FILTERGRAPH_HPP
 
-#include "accessgraph.hpp"
+#include "clustergraph.hpp"
 
 #include <boost/graph/filtered_graph.hpp>
 
@@ -48,7 +48,7 @@ template<typename Graph>
 struct create_filtered_graph {
     
     template<typename T1, typename T2, typename T3, typename T4, typename T5>
-    using type = boost::filtered_graph<boost::adjacency_list<T1,T2,T3,T4,T5>, 
+    using type = boost::filtered_graph<graph::adjacency_list<T1,T2,T3,T4,T5>, 
                                     group_filter<Graph>, group_filter<Graph>>;
 };
 
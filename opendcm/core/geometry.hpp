@@ -22,6 +22,7 @@
 #define DCM_GEOMETRY_H
 
 #include <vector>
+#include <type_traits>
 
 #include <Eigen/Core>
 #include <Eigen/Dense>
@@ -30,6 +31,8 @@
 #include <boost/mpl/vector.hpp>
 #include <boost/mpl/range_c.hpp>
 #include <boost/mpl/for_each.hpp>
+#include <boost/mpl/at.hpp>
+#include <boost/mpl/size.hpp>
 #include <boost/fusion/include/vector.hpp>
 #include <boost/fusion/include/make_vector.hpp>
 #include <boost/fusion/include/as_vector.hpp>
@@ -91,6 +94,58 @@ namespace dcm {
  * As the example above needs quite some boilerplate for a primitve type helper classes are provided in this
  * namespace which ease the creation of geometric primitives.
  */
+namespace detail {
+    
+//amount of scalars in a storage entry, which is 1 for scalars and the size of fixed size matrices
+template<typename T, bool = std::is_arithmetic<T>::value>
+struct entrySize : std::integral_constant<int, 1> {};
+
+template<typename T>
+struct entrySize<T, false> : std::integral_constant<int, T::SizeAtCompileTime> {};
+
+template<typename... T>
+struct entrySizes : std::integral_constant<int, 0> {};
+
+template<typename T, typename... Rest>
+struct entrySizes<T, Rest...> 
+    : std::integral_constant<int, entrySize<T>::value + entrySizes<Rest...>::value> {};
+
+//copy storage entries from/into contiguous arrays by mapping the array onto every entry
+template<typename Scalar>
+struct ArrayReader {
+    
+    const Scalar*& m_data;
+    ArrayReader(const Scalar*& data) : m_data(data) {};
+    
+    template<typename T>
+    void operator()(Eigen::MatrixBase<T>& m) const {
+        m = Eigen::Map<const typename T::PlainObject>(m_data);
+        m_data += T::SizeAtCompileTime;
+    };
+    void operator()(Scalar& s) const {
+        s = *(m_data++);
+    };
+};
+
+template<typename Scalar>
+struct ArrayWriter {
+    
+    Scalar*& m_data;
+    ArrayWriter(Scalar*& data) : m_data(data) {};
+    
+    template<typename T>
+    void operator()(const Eigen::MatrixBase<T>& m) const {
+        Eigen::Map<typename T::PlainObject> map(m_data);
+        map = m;
+        m_data += T::SizeAtCompileTime;
+    };
+    void operator()(const Scalar& s) const {
+        *(m_data++) = s;
+    };
+};
+    
+} //detail
+
 namespace geometry {
 
 /**
@@ -131,13 +186,76 @@ namespace geometry {
 template<typename Kernel, typename... StorageTypes>
 struct Geometry {
 
+    typedef typename Kernel::Scalar                                      Scalar;
     typedef mpl::vector< StorageTypes... >                               StorageSequence;
     typedef typename fusion::result_of::as_vector<StorageSequence>::type Storage;
     
+    //amount of scalars needed to store all values of this geometry in a contiguous array
+    static const int ArraySize = detail::entrySizes<StorageTypes...>::value;
+    
+    /**
+     * @brief Copies the values from a contiguous array
+     * 
+     * The storage entries are read in order, matrices in eigens column major order. This is done by 
+     * mapping the array directly into each storage entry, no per element access is needed.
+     * 
+     * @param data Array holding at least \ref ArraySize values
+     * @return const Scalar* Position behind the last read value
+     */
+    const Scalar* fromArray(const Scalar* data) {
+        fusion::for_each(m_storage, detail::ArrayReader<Scalar>(data));
+        return data;
+    };
+    
+    /**
+     * @brief Copies the values into a contiguous array
+     * 
+     * The layout is the same as used in \ref fromArray.
+     * 
+     * @param data Array with space for at least \ref ArraySize values
+     * @return Scalar* Position behind the last written value
+     */
+    Scalar* toArray(Scalar* data) const {
+        fusion::for_each(m_storage, detail::ArrayWriter<Scalar>(data));
+        return data;
+    };
+    
 protected:
     Storage m_storage;
 };
 
+/**
+ * @brief Reads a sequence of geometries from a contiguous array
+ * 
+ * All geometries in the range [begin, end) are filled from consecutive blocks of the array with the 
+ * layout described in \ref Geometry::fromArray. This is the bulk way to import large geometry sets 
+ * from user arrays.
+ * 
+ * @return const Scalar* Position behind the last read value
+ */
+template<typename Iterator, typename Scalar>
+const Scalar* fromArray(const Scalar* data, Iterator begin, Iterator end) {
+    for(; begin != end; ++begin)
+        data = begin->fromArray(data);
+    
+    return data;
+};
+
+/**
+ * @brief Writes a sequence of geometries into a contiguous array
+ * 
+ * Counterpart of \ref fromArray, the array needs space for ArraySize values per geometry.
+ * 
+ * @return Scalar* Position behind the last written value
+ */
+template<typename Iterator, typename Scalar>
+Scalar* toArray(Scalar* data, Iterator begin, Iterator end) {
+    for(; begin != end; ++begin)
+        data = begin->toArray(data);
+    
+    return data;
+};
+
 /**
  * @brief Extractor of geometry base from initialized type
  * 
@@ -162,6 +280,18 @@ struct extractor<Base<Kernel>> {
 
 namespace detail {
 //helper classes for numeric geometry
+template<typename Kernel>
+struct Zero {
+
+    template<typename T>
+    void operator()(Eigen::MatrixBase<T>& m) const {
+        m.setZero();
+    };
+    void operator()(typename Kernel::Scalar& s) const {
+        s = 0;
+    };
+};
+
 template<typename Kernel, typename StorageType, typename Equation, bool InitDerivative = true>
 struct Initializer {
 
@@ -188,6 +318,9 @@ struct Initializer {
             m_derivatives.emplace_back(typename Equation::DerivativePack(typename Equation::OutputType(),  v[i]));
             
             if(InitDerivative) {
+                //eigen does not initialize its matrices, hence the derivative needs to be cleared
+                //before the only non-zero entry is set
+                fusion::for_each(m_derivatives.back().first.m_storage, Zero<Kernel>());
                 auto& t2 = fusion::at<T>(m_derivatives.back().first.m_storage);
                 setOne(t2, i);
             }
@@ -223,6 +356,21 @@ struct Initializer {
     };
 };
 
+//forwards the initialisation of all storage entries except the one at position Skip
+template<typename Initializer, int Skip>
+struct SkipInitializer {
+
+    Initializer m_initializer;
+
+    SkipInitializer(const Initializer& init) : m_initializer(init) {};
+
+    template<typename T>
+    void operator()(T t) {
+        if(T::value != Skip)
+            m_initializer(t);
+    };
+};
+
 template<typename Kernel>
 struct Counter {
 
@@ -275,6 +423,38 @@ struct Assigner {
     }
 };
 
+//assigns all storage entries except the one at position Skip sequentially from the parameters
+template<typename Equation, int Skip>
+struct SkipAssigner {
+
+    typedef typename Equation::KernelType::Scalar Scalar;
+
+    int& m_count;
+    std::vector<typename Equation::Parameter>& m_params;
+    typename Equation::Storage& m_storage;
+
+    SkipAssigner(typename Equation::Storage& s, std::vector<typename Equation::Parameter>& p, int& c)
+        : m_storage(s), m_params(p), m_count(c) {
+        m_count = -1;
+    };
+
+    template<typename T>
+    void operator()(T t) const {
+        if(T::value != Skip)
+            assign(fusion::at<T>(m_storage));
+    };
+
+    template<typename T>
+    void assign(Eigen::MatrixBase<T>& t) const {
+        for(int i=0; i<(t.rows()*t.cols()); ++i)
+            t(i) = m_params[++m_count];
+    };
+
+    void assign(Scalar& t) const {
+        t = m_params[++m_count];
+    };
+};
+
 };//detail
     
 namespace numeric {
@@ -357,6 +537,141 @@ protected:
                         //for every recalculate
 };
 
+/**
+ * @brief Numeric geometry with a minimal parametrization of its direction
+ *
+ * Many geometries like lines, planes or cylinders store a direction as 3D vector. Only the orientation of 
+ * this vector is of interest, its length is a gauge freedom which adds a superfluous parameter to the system
+ * and requires normalisation in every equation using it. This class maps all storage entries like 
+ * \ref Geometry does, except the direction. That one is described by two parameters u and v in the tangent
+ * space of a reference direction r:
+ * \f[ d = \frac{r + u t_1 + v t_2}{|r + u t_1 + v t_2|} \f]
+ * with \f$ t_1, t_2 \f$ being an orthonormal basis perpendicular to r. The calculated direction is therefore
+ * always normalized. As the parametrization only covers the half sphere around the reference, the geometry
+ * registers \ref recenter with the \ref LinearSystem in \ref init. The nonlinear solvers call it after every
+ * accepted step, which moves the reference to the current direction and resets the tangent parameters
+ * to zero.
+ *
+ * The reference direction is taken from the geometry's direction value at initialisation, hence it must be 
+ * set to a non-zero vector before \ref init is called. The tangent parameters are appended after all other
+ * parameters.
+ *
+ * \tparam Kernel The math \ref Kernel in use
+ * \tparam Base The geometric primitive on which the numeric geometry is based on as non-specialized 
+ *              template type
+ * \tparam Direction The storage position of the 3D direction vector
+ */
+template< typename Kernel, template<class> class Base, int Direction = 1 >
+struct TangentDirectionGeometry : public Equation<Kernel, Base<Kernel>> {
+
+    typedef Equation<Kernel, Base<Kernel>> Inherited;
+    typedef typename Kernel::Scalar        Scalar;
+    typedef numeric::Vector<Kernel, 3>     Vector3;
+
+    typedef mpl::range_c<int,0,
+            mpl::size<typename Inherited::StorageSequence>::value> StorageRange;
+
+    static_assert(std::is_same<typename mpl::at_c<typename Inherited::StorageSequence, Direction>::type, 
+                               Vector3>::value, "Direction storage entry must be a 3D vector");
+                
+    TangentDirectionGeometry() {
+        Inherited::m_complexity = Complexity::Complex;
+        fusion::for_each(Inherited::m_storage, detail::Counter<Kernel>(Inherited::m_parameterCount));
+        //the three direction values are replaced by two tangent parameters
+        Inherited::m_parameterCount -= 1;
+    };
+    
+    virtual void init(LinearSystem<Kernel>& sys) {
+#ifdef DCM_DEBUG
+        dcm_assert(!Inherited::m_init);
+        Inherited::m_init = true;
+#endif
+        typedef detail::Initializer<Kernel, typename Inherited::Storage, Inherited> Init;
+        mpl::for_each<StorageRange>(detail::SkipInitializer<Init, Direction>(Init(sys, Inherited::m_storage, 
+                                    Inherited::m_parameters, Inherited::m_derivatives)));
+        
+        dcm_assert(directionValue().norm() > 0);
+        m_reference = directionValue().normalized();
+        
+        //the tangent parameters only influence the direction, all other derivatives stay zero
+        for(int i=0; i<2; ++i) {
+            typename Inherited::Parameter param = sys.mapParameter();
+            *param.Value = 0;
+            Inherited::m_parameters.push_back(param);
+            Inherited::m_derivatives.emplace_back(typename Inherited::DerivativePack(
+                                                  typename Inherited::OutputType(), param));
+            fusion::for_each(Inherited::m_derivatives.back().first.m_storage, detail::Zero<Kernel>());
+        };
+        
+        buildBasis();
+        sys.addRecentering([this]() {recenter();});
+    };
+    
+    /**
+     * @brief Moves the reference direction to the current direction
+     * 
+     * Sets the reference to the last calculated direction and resets the tangent parameters to zero. 
+     * Afterwards the geometry describes the same direction as before, but the tangent space is centered
+     * at it again.
+     */
+    void recenter() {
+        
+        m_reference = directionValue();
+        *tangentU().Value = 0;
+        *tangentV().Value = 0;
+        buildBasis();
+    };
+    
+    const Vector3& reference() const {
+        return m_reference;
+    };
+    
+    CALCULATE() {
+        
+        mpl::for_each<StorageRange>(detail::SkipAssigner<Inherited, Direction>(Inherited::m_storage, 
+                                    Inherited::m_parameters, m_counter));
+        
+        const Vector3  w    = m_reference + *tangentU().Value*m_tangent1 + *tangentV().Value*m_tangent2;
+        const Scalar   norm = w.norm();
+        directionValue() = w/norm;
+        
+        //derivative of the normalized vector projects the tangent onto the plane perpendicular to d
+        const std::size_t size = Inherited::m_derivatives.size();
+        fusion::at_c<Direction>(Inherited::m_derivatives[size-2].first.m_storage) 
+                = (m_tangent1 - directionValue()*directionValue().dot(m_tangent1))/norm;
+        fusion::at_c<Direction>(Inherited::m_derivatives[size-1].first.m_storage) 
+                = (m_tangent2 - directionValue()*directionValue().dot(m_tangent2))/norm;
+    };
+    
+protected:
+    Vector3& directionValue() {
+        return fusion::at_c<Direction>(Inherited::m_storage);
+    };
+    
+    typename Inherited::Parameter& tangentU() {
+        return Inherited::m_parameters[Inherited::m_parameters.size()-2];
+    };
+    
+    typename Inherited::Parameter& tangentV() {
+        return Inherited::m_parameters.back();
+    };
+    
+    //build a orthonormal basis perpendicular to the reference, using the axis least aligned 
+    //with it to stay numerically stable
+    void buildBasis() {
+        
+        int axis;
+        m_reference.cwiseAbs().minCoeff(&axis);
+        m_tangent1 = m_reference.cross(Vector3::Unit(axis)).normalized();
+        m_tangent2 = m_reference.cross(m_tangent1);
+    };
+    
+    Vector3 m_reference, m_tangent1, m_tangent2;
+    
+    int m_counter = -1; //we need a counter for every calculate, and we do not want a memory allocation 
+                        //for every recalculate
+};
+
 /**
  * @brief Base class for geometry which calculates its value from a set of parameters
  * 
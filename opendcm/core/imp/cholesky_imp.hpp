@@ -0,0 +1,359 @@
+/*
+    openDCM, dimensional constraint manager
+    Copyright (C) 2015  Stefan Troeger <stefantroeger@gmx.net>
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along
+    with this library; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef DCM_CHOLESKY_IMP_H
+#define DCM_CHOLESKY_IMP_H
+
+#include "../cholesky.hpp"
+
+namespace dcm {
+namespace numeric {
+
+/****************************************************************************************************/
+//BlockCholesky
+
+template<typename Kernel>
+void BlockCholesky<Kernel>::analyze(const std::vector<int>& blockSizes, const std::vector<std::vector<int>>& adjacency) {
+
+    dcm_assert(blockSizes.size() == adjacency.size());
+
+    const int n = blockSizes.size();
+    m_sizes = blockSizes;
+    m_start.resize(n);
+    m_blockOf.clear();
+    for(int i=0, s=0; i<n; ++i) {
+        m_start[i] = s;
+        s += m_sizes[i];
+        m_blockOf.insert(m_blockOf.end(), m_sizes[i], i);
+    }
+
+    //elimination tree with path compression (Liu)
+    std::vector<int> parent(n, -1), ancestor(n, -1);
+    for(int j=0; j<n; ++j) {
+        for(int i : adjacency[j]) {
+            for(int r = i; r < j && r != -1; ) {
+                const int next = ancestor[r];
+                ancestor[r] = j;
+                if(next == -1)
+                    parent[r] = j;
+                r = next;
+            }
+        }
+    }
+
+    m_children.assign(n, std::vector<int>());
+    m_roots.clear();
+    for(int j=0; j<n; ++j)
+        (parent[j] == -1 ? m_roots : m_children[parent[j]]).push_back(j);
+
+    //the factor structure of a column is its own lower adjacency joined with the structure of its
+    //children. Children are always numbered lower than their parent
+    m_rows.assign(n, std::vector<int>());
+    m_updates.assign(n, std::vector<std::pair<int,int>>());
+    std::vector<int> merged;
+    for(int j=0; j<n; ++j) {
+
+        std::vector<int>& rows = m_rows[j];
+        for(int i : adjacency[j])
+            if(i > j)
+                rows.push_back(i);
+
+        std::sort(rows.begin(), rows.end());
+        rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+        //the first offdiagonal row of a child is always its parent, which is j
+        for(int c : m_children[j]) {
+            merged.clear();
+            std::set_union(rows.begin(), rows.end(), m_rows[c].begin()+2, m_rows[c].end(),
+                           std::back_inserter(merged));
+            rows.swap(merged);
+        }
+        rows.insert(rows.begin(), j);
+        dcm_assert(parent[j] == -1 || rows[1] == parent[j]);
+    }
+
+    //panel layout and the update lists
+    m_offsets.assign(n, std::vector<int>());
+    m_panels.resize(n);
+    for(int j=0; j<n; ++j) {
+
+        int offset = 0;
+        for(int i : m_rows[j]) {
+            m_offsets[j].push_back(offset);
+            offset += m_sizes[i];
+        }
+        m_panels[j].resize(offset, m_sizes[j]);
+
+        for(int q=1; q<m_rows[j].size(); ++q)
+            m_updates[m_rows[j][q]].push_back(std::make_pair(j, q));
+    }
+};
+
+template<typename Kernel>
+void BlockCholesky<Kernel>::factorize(const SparseMatrix& A) {
+
+    dcm_assert(A.rows() == m_blockOf.size() && A.cols() == m_blockOf.size());
+
+    for(MatrixX& panel : m_panels)
+        panel.setZero();
+
+    for(int c=0; c<A.outerSize(); ++c) {
+        const int bc = m_blockOf[c];
+        for(typename SparseMatrix::InnerIterator it(A, c); it; ++it) {
+            const int r = it.row();
+            if(r < c)
+                continue;
+
+            const int q = position(bc, m_blockOf[r]);
+            m_panels[bc](m_offsets[bc][q] + r - m_start[m_blockOf[r]], c - m_start[bc]) += it.value();
+        }
+    }
+
+    std::atomic<bool> success(true);
+    auto column = [&](int j) {
+        if(!factorizeColumn(j))
+            success = false;
+    };
+    if(parallel)
+        shedule::for_each_postorder(m_children, m_roots, column, grainsize);
+    else {
+        for(int j=0; j<m_panels.size(); ++j)
+            column(j);
+    }
+
+    m_info = success ? Eigen::Success : Eigen::NumericalIssue;
+};
+
+template<typename Kernel>
+typename BlockCholesky<Kernel>::MatrixX BlockCholesky<Kernel>::solve(const MatrixX& b) const {
+
+    dcm_assert(m_info == Eigen::Success);
+
+    MatrixX x = b;
+    const int n = m_panels.size();
+
+    //forward substitution with L
+    for(int j=0; j<n; ++j) {
+        const MatrixX& panel = m_panels[j];
+        auto xj = x.middleRows(m_start[j], m_sizes[j]);
+        panel.topRows(m_sizes[j]).template triangularView<Eigen::Lower>().solveInPlace(xj);
+        for(int q=1; q<m_rows[j].size(); ++q) {
+            const int i = m_rows[j][q];
+            x.middleRows(m_start[i], m_sizes[i]).noalias() -= panel.middleRows(m_offsets[j][q], m_sizes[i])*xj;
+        }
+    }
+
+    //backward substitution with L^T
+    for(int j=n-1; j>=0; --j) {
+        const MatrixX& panel = m_panels[j];
+        auto xj = x.middleRows(m_start[j], m_sizes[j]);
+        for(int q=1; q<m_rows[j].size(); ++q) {
+            const int i = m_rows[j][q];
+            xj.noalias() -= panel.middleRows(m_offsets[j][q], m_sizes[i]).transpose()*x.middleRows(m_start[i], m_sizes[i]);
+        }
+        panel.topRows(m_sizes[j]).template triangularView<Eigen::Lower>().transpose().solveInPlace(xj);
+    }
+    return x;
+};
+
+template<typename Kernel>
+bool BlockCholesky<Kernel>::factorizeColumn(int j) {
+
+    MatrixX& panel = m_panels[j];
+    const int sj   = m_sizes[j];
+
+    //gather the updates of all descendants which have a nonzero block in row j
+    MatrixX update;
+    for(const std::pair<int,int>& k : m_updates[j]) {
+
+        const MatrixX& lk    = m_panels[k.first];
+        const int      begin = m_offsets[k.first][k.second];
+        const int      h     = lk.rows() - begin;
+        update.noalias() = lk.bottomRows(h) * lk.middleRows(begin, sj).transpose();
+
+        const std::vector<int>& rows = m_rows[k.first];
+        for(int q = k.second; q < rows.size(); ++q) {
+            const int i = rows[q];
+            panel.middleRows(m_offsets[j][position(j, i)], m_sizes[i])
+                -= update.middleRows(m_offsets[k.first][q] - begin, m_sizes[i]);
+        }
+    }
+
+    //dense kernels for the diagonal block and the panel below
+    Eigen::LLT<MatrixX> llt(panel.topRows(sj));
+    if(llt.info() != Eigen::Success)
+        return false;
+
+    panel.topRows(sj) = llt.matrixL();
+    if(panel.rows() > sj) {
+        auto below = panel.bottomRows(panel.rows() - sj);
+        llt.matrixU().template solveInPlace<Eigen::OnTheRight>(below);
+    }
+    return true;
+};
+
+/****************************************************************************************************/
+//DomainDecomposition
+
+template<typename Kernel>
+void DomainDecomposition<Kernel>::analyze(const std::vector<int>& blockSizes, 
+                                          const std::vector<std::vector<int>>& adjacency) {
+
+    dcm_assert(blockSizes.size() == adjacency.size());
+
+    const int n = blockSizes.size();
+    m_part = ordering::partition(adjacency, domains, blockSizes);
+    ordering::separate(adjacency, m_part);
+
+    std::vector<int> start(n);
+    int size = 0;
+    for(int i=0; i<n; ++i) {
+        start[i] = size;
+        size += blockSizes[i];
+    }
+
+    m_solver.clear();
+    m_offsets.assign(1, 0);
+    m_indices.clear();
+    std::vector<int> local(n, -1);
+    for(int d=0; d<domains; ++d) {
+
+        std::vector<int> blocks;
+        for(int i=0; i<n; ++i)
+            if(m_part[i] == d)
+                blocks.push_back(i);
+
+        for(int i=0; i<blocks.size(); ++i)
+            local[blocks[i]] = i;
+
+        std::vector<std::vector<int>> subAdjacency(blocks.size());
+        for(int i=0; i<blocks.size(); ++i)
+            for(int b : adjacency[blocks[i]])
+                if(m_part[b] == d)
+                    subAdjacency[i].push_back(local[b]);
+
+        //fill reducing order inside the subdomain
+        const std::vector<int> order = ordering::nestedDissection(subAdjacency);
+        std::vector<int> orderedSizes;
+        std::vector<std::vector<int>> orderedAdjacency(order.size());
+        for(int i=0; i<order.size(); ++i)
+            local[blocks[order[i]]] = i;
+        for(int i=0; i<order.size(); ++i) {
+            const int block = blocks[order[i]];
+            orderedSizes.push_back(blockSizes[block]);
+            for(int b : adjacency[block])
+                if(m_part[b] == d)
+                    orderedAdjacency[i].push_back(local[b]);
+            for(int p=0; p<blockSizes[block]; ++p)
+                m_indices.push_back(start[block]+p);
+        }
+
+        m_solver.emplace_back();
+        m_solver.back().parallel = false;
+        m_solver.back().analyze(orderedSizes, orderedAdjacency);
+        m_offsets.push_back(m_indices.size());
+    }
+
+    for(int i=0; i<n; ++i)
+        if(m_part[i] == -1)
+            for(int p=0; p<blockSizes[i]; ++p)
+                m_indices.push_back(start[i]+p);
+
+    //permutation from original to decomposed order
+    m_permutation.resize(size);
+    for(int i=0; i<size; ++i)
+        m_permutation.indices()(m_indices[i]) = i;
+};
+
+template<typename Kernel>
+void DomainDecomposition<Kernel>::factorize(const SparseMatrix& A) {
+
+    dcm_assert(A.rows() == m_permutation.size() && A.cols() == m_permutation.size());
+
+    SparseMatrix Ap;
+    Ap = A.twistedBy(m_permutation);
+    const int separator = separatorSize();
+    const int begin = m_offsets.back();
+
+    m_block.resize(domains);
+    m_coupling.resize(domains);
+    m_schur.resize(domains);
+    std::vector<int> failed(domains, 0);
+    auto eliminate = [&](int d) {
+
+        const int offset = m_offsets[d], size = m_offsets[d+1] - m_offsets[d];
+        m_solver[d].factorize(Ap.block(offset, offset, size, size));
+        if(m_solver[d].info() != Eigen::Success) {
+            failed[d] = 1;
+            return;
+        }
+        m_block[d]    = Ap.block(offset, begin, size, separator);
+        m_coupling[d] = m_solver[d].solve(MatrixX(m_block[d]));
+        m_schur[d]    = m_block[d].transpose()*m_coupling[d];
+    };
+    forEachDomain(eliminate);
+
+    m_info = Eigen::Success;
+    if(std::find(failed.begin(), failed.end(), 1) != failed.end()) {
+        m_info = Eigen::NumericalIssue;
+        return;
+    }
+
+    MatrixX S = MatrixX(Ap.block(begin, begin, separator, separator));
+    for(const MatrixX& schur : m_schur)
+        S -= schur;
+
+    m_separator.compute(S);
+    if(m_separator.info() != Eigen::Success)
+        m_info = Eigen::NumericalIssue;
+};
+
+template<typename Kernel>
+typename DomainDecomposition<Kernel>::VectorX DomainDecomposition<Kernel>::solve(const VectorX& b) const {
+
+    dcm_assert(m_info == Eigen::Success);
+
+    const VectorX bp = m_permutation*b;
+    const int separator = separatorSize();
+
+    //eliminate the subdomains from the right hand side
+    std::vector<VectorX> y(domains);
+    forEachDomain([&](int d) {
+        const int offset = m_offsets[d], size = m_offsets[d+1] - m_offsets[d];
+        y[d] = m_solver[d].solve(VectorX(bp.segment(offset, size)));
+    });
+
+    VectorX rs = bp.tail(separator);
+    for(int d=0; d<domains; ++d)
+        rs -= m_block[d].transpose()*y[d];
+
+    VectorX x(bp.rows());
+    x.tail(separator) = m_separator.solve(rs);
+    forEachDomain([&](int d) {
+        const int offset = m_offsets[d], size = m_offsets[d+1] - m_offsets[d];
+        x.segment(offset, size) = y[d] - m_coupling[d]*x.tail(separator);
+    });
+
+    return m_permutation.transpose()*x;
+};
+
+}//numeric
+}//dcm
+
+#endif //DCM_CHOLESKY_IMP_H
@@ -0,0 +1,484 @@
+/*
+    openDCM, dimensional constraint manager
+    Copyright (C) 2015  Stefan Troeger <stefantroeger@gmx.net>
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along
+    with this library; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef DCM_KERNEL_IMP_H
+#define DCM_KERNEL_IMP_H
+
+#include "../kernel.hpp"
+
+namespace dcm {
+namespace numeric {
+
+/****************************************************************************************************/
+//LinearSolver
+
+template<typename Kernel>
+void LinearSolver<Kernel>::analyze(LinearSystem<Kernel>& sys) {
+    
+    m_backend = policy.select(sys);
+    if(m_backend == LinearBackend::FixedDense && sys.jacobi().cols() > BackendPolicy::MaxFixedSize)
+        m_backend = LinearBackend::DenseLDLT;
+    if(m_backend == LinearBackend::DomainDecomposition && sys.blockSizes().empty())
+        m_backend = LinearBackend::SparseDirect;
+    
+    if(m_backend == LinearBackend::DomainDecomposition) {
+        m_domains.parallel = parallel;
+        m_domains.analyze(sys.blockSizes(), sys.blockAdjacency());
+    }
+    m_blocks = m_backend == LinearBackend::SparseDirect && !sys.blockSizes().empty();
+    if(m_blocks) {
+        m_cholesky.parallel = parallel;
+        m_cholesky.analyze(sys.blockSizes(), sys.blockAdjacency());
+    }
+};
+
+template<typename Kernel>
+bool LinearSolver<Kernel>::solve(const MatrixX& J, const VectorX& F, VectorX& h) {
+    
+    switch(m_backend) {
+        case LinearBackend::FixedDense: {
+            const FixedMatrix A = J.transpose()*J;
+            const FixedVector b = -J.transpose()*F;
+            h = Eigen::LDLT<FixedMatrix>(A).solve(b);
+            break;
+        }
+        case LinearBackend::DenseQR:
+            h = J.colPivHouseholderQr().solve(-F);
+            break;
+        case LinearBackend::SparseDirect: 
+        case LinearBackend::DomainDecomposition:
+            return solveSparse(J, F, h);
+        case LinearBackend::MatrixFree:
+            return solveIterative(J, F, h);
+        default: {
+            const MatrixX A = J.transpose()*J;
+            h = A.ldlt().solve(-J.transpose()*F);
+        }
+    }
+    return h.allFinite();
+};
+
+template<typename Kernel>
+bool LinearSolver<Kernel>::solveSparse(const MatrixX& J, const VectorX& F, VectorX& h) {
+    
+    const SparseMatrix Js = J.sparseView();
+    const VectorX      b  = -J.transpose()*F;
+    
+    SparseMatrix A = Js.transpose()*Js;
+    SparseMatrix D(A.rows(), A.cols());
+    D.setIdentity();
+    Scalar mu = damping*std::max(A.diagonal().maxCoeff(), Scalar(1));
+    
+    //increase the damping if the factorization fails due to rank deficiency
+    for(int i=0; i<4; ++i, mu *= 1e4) {
+        if(m_backend == LinearBackend::DomainDecomposition) {
+            m_domains.factorize(A + mu*D);
+            if(m_domains.info() == Eigen::Success) {
+                h = m_domains.solve(b);
+                return true;
+            }
+        }
+        else if(m_blocks) {
+            m_cholesky.factorize(A + mu*D);
+            if(m_cholesky.info() == Eigen::Success) {
+                h = m_cholesky.solve(b);
+                return true;
+            }
+        }
+        else {
+            Eigen::SimplicialLDLT<SparseMatrix> ldlt(A + mu*D);
+            if(ldlt.info() == Eigen::Success) {
+                h = ldlt.solve(b);
+                if(h.allFinite())
+                    return true;
+            }
+        }
+    }
+    return false;
+};
+
+template<typename Kernel>
+bool LinearSolver<Kernel>::solveIterative(const MatrixX& J, const VectorX& F, VectorX& h) {
+    
+    const VectorX b = -J.transpose()*F;
+    VectorX diag = J.colwise().squaredNorm().transpose();
+    for(int i=0; i<diag.rows(); ++i)
+        diag(i) = (diag(i) > 0) ? 1/diag(i) : 1;
+    
+    h = VectorX::Zero(J.cols());
+    VectorX r = b, z = diag.cwiseProduct(r), p = z, Ap;
+    Scalar rz = r.dot(z);
+    const Scalar limit = tolerance*tolerance*b.squaredNorm();
+    
+    for(int i=0; i<2*J.cols() && r.squaredNorm() > limit; ++i) {
+        Ap = J.transpose()*(J*p);
+        const Scalar pAp = p.dot(Ap);
+        if(pAp <= 0)
+            break;
+        
+        const Scalar alpha = rz/pAp;
+        h += alpha*p;
+        r -= alpha*Ap;
+        z  = diag.cwiseProduct(r);
+        const Scalar rz_new = r.dot(z);
+        p  = z + (rz_new/rz)*p;
+        rz = rz_new;
+    }
+    return h.allFinite();
+};
+
+/****************************************************************************************************/
+//Dogleg
+
+template<typename Kernel>
+SolverResult Dogleg<Kernel>::solve(LinearSystem<Kernel>& sys, const std::function<void()>& recalculate) {
+    
+    //already solved systems, e.g. after loading a file, only need the residuals. Note that the 
+    //jacobian is not updated in this case. Otherwise the residuals of the check are kept and only 
+    //the jacobian is added
+    if(precheck) {
+        if(isSatisfied(sys, recalculate)) {
+            iter = 0;
+            err  = sys.cost();
+            return SolverResult::Converged;
+        }
+        evaluate(sys, recalculate, Evaluation::Derivatives);
+    }
+    else 
+        recalculate();
+    
+    linear.analyze(sys);
+    sys.effectiveWeights(sqrtw);
+    sqrtw = sqrtw.cwiseSqrt();
+    F  = sqrtw.cwiseProduct(sys.residuals());
+    J  = sqrtw.asDiagonal()*sys.jacobi();
+    updateScaling(J, D, true);
+    Js = J*D.cwiseInverse().asDiagonal();
+    g  = Js.transpose()*F;
+    err = sys.cost();
+    
+    //all steps are calculated in the scaled variables z = D*h
+    Scalar radius = delta;
+    
+    for(iter = 0; iter < maxIterations; ++iter) {
+        
+        if(isConverged(sys))
+            return SolverResult::Converged;
+        if(g.template lpNorm<Eigen::Infinity>() <= tolg)
+            return SolverResult::SmallGradient;
+        
+        calculateStep(g, Js, F, z_dl, radius);
+        if(z_dl.norm() <= tolx*(D.cwiseProduct(sys.parameter()).norm() + tolx))
+            return SolverResult::SmallStep;
+        
+        //the gain predicted by the (reweighted) linear model
+        const Scalar dL = F.squaredNorm() - (F + Js*z_dl).squaredNorm();
+        
+        h_dl  = z_dl.cwiseQuotient(D);
+        x_old = sys.parameter();
+        sys.parameter() += h_dl;
+        recalculate();
+        
+        const Scalar err_new = sys.cost();
+        const Scalar dF      = err - err_new;
+        
+        if(dF > 0 && dL > 0) {
+            
+            const Scalar rho = dF/dL;
+            if(rho > 0.75)
+                radius = std::max(radius, 3*z_dl.norm());
+            else if(rho < 0.25)
+                radius /= 2;
+            
+            recenter(sys, recalculate);
+            
+            //robust losses need new weights for the new residuals
+            if(sys.hasRobustResiduals()) {
+                sys.effectiveWeights(sqrtw);
+                sqrtw = sqrtw.cwiseSqrt();
+            }
+            
+            F   = sqrtw.cwiseProduct(sys.residuals());
+            J   = sqrtw.asDiagonal()*sys.jacobi();
+            updateScaling(J, D, false);
+            Js  = J*D.cwiseInverse().asDiagonal();
+            g   = Js.transpose()*F;
+            err = err_new;
+        }
+        else {
+            //reject the step and restore the old state
+            sys.parameter() = x_old;
+            recalculate();
+            radius /= 4;
+        }
+    }
+    
+    return SolverResult::MaxIterations;
+};
+
+template<typename Kernel>
+bool Dogleg<Kernel>::isSatisfied(LinearSystem<Kernel>& sys, const std::function<void()>& recalculate) {
+    
+    evaluate(sys, recalculate, Evaluation::Residuals);
+    return isConverged(sys);
+};
+
+template<typename Kernel>
+bool Dogleg<Kernel>::isConverged(LinearSystem<Kernel>& sys) {
+    
+    return sys.weights().cwiseSqrt().cwiseProduct(sys.residuals()).template lpNorm<Eigen::Infinity>() <= tolf;
+};
+
+template<typename Kernel>
+void Dogleg<Kernel>::updateScaling(const MatrixX& J, VectorX& D, bool init) {
+    
+    if(init) 
+        D = VectorX::Ones(J.cols());
+    
+    if(!equilibrate)
+        return;
+    
+    for(int i=0; i<J.cols(); ++i) {
+        const Scalar n = J.col(i).norm();
+        if(init)
+            D(i) = (n > 0) ? n : 1;
+        else 
+            D(i) = std::max(D(i), n);
+    }
+};
+
+template<typename Kernel>
+void Dogleg<Kernel>::calculateStep(const VectorX& g, const MatrixX& J, const VectorX& F, VectorX& h_dl, 
+                                   const Scalar radius) {
+    
+    //row scaling does not change the solution of consistent equations, hence it is only applied if 
+    //there are not more rows than parameters
+    const bool scaled = equilibrate && J.rows() <= J.cols();
+    if(scaled) {
+        R = J.rowwise().norm();
+        for(int i=0; i<R.rows(); ++i)
+            R(i) = (R(i) > 0) ? 1/R(i) : 1;
+        
+        Jr = R.asDiagonal()*J;
+        Fr = R.cwiseProduct(F);
+    }
+    const MatrixX& Jg = scaled ? Jr : J;
+    const VectorX& Fg = scaled ? Fr : F;
+    
+    //gauss newton step from the selected backend, the rank revealing QR as fallback for rank 
+    //deficient systems
+    if(linear.backend() == LinearBackend::DenseQR || !linear.solve(Jg, Fg, h_gn))
+        h_gn = Jg.colPivHouseholderQr().solve(-Fg);
+    
+    if(h_gn.norm() <= radius) {
+        h_dl = h_gn;
+        return;
+    }
+    
+    //steepest descent step with optimal length for the linear model
+    const Scalar alpha = g.squaredNorm()/(J*g).squaredNorm();
+    const VectorX h_sd = -alpha*g;
+    if(h_sd.norm() >= radius) {
+        h_dl = (radius/h_sd.norm())*h_sd;
+        return;
+    }
+    
+    //the point on the line h_sd -> h_gn that hits the trust region border
+    const VectorX diff = h_gn - h_sd;
+    const Scalar  a = diff.squaredNorm();
+    const Scalar  b = h_sd.dot(diff);
+    const Scalar  c = h_sd.squaredNorm() - radius*radius;
+    const Scalar  beta = (-b + std::sqrt(b*b - a*c))/a;
+    h_dl = h_sd + beta*diff;
+};
+
+/****************************************************************************************************/
+//PrioritySolver
+
+template<typename Kernel>
+SolverResult PrioritySolver<Kernel>::solve(LinearSystem<Kernel>& sys, const std::function<void()>& recalculate) {
+    
+    //sort the rows into their priority levels
+    std::map<int, std::vector<int>> levelMap;
+    for(int i=0; i<sys.priorities().rows(); ++i)
+        levelMap[sys.priorities()(i)].push_back(i);
+    
+    std::vector<std::vector<int>> levels;
+    for(auto& level : levelMap)
+        levels.push_back(std::move(level.second));
+    
+    const bool hard = !levelMap.empty() && levelMap.begin()->first == 0;
+    
+    //every level is at its optimum if all residuals vanish, the jacobian is not needed then
+    if(precheck) {
+        evaluate(sys, recalculate, Evaluation::Residuals);
+        if(sys.residuals().template lpNorm<Eigen::Infinity>() <= tolf) {
+            iter = 0;
+            return result(sys, hard, levels);
+        }
+        evaluate(sys, recalculate, Evaluation::Derivatives);
+    }
+    else
+        recalculate();
+    
+    linear.analyze(sys);
+    std::vector<Scalar> merit = levelErrors(sys, levels);
+    VectorX h, x_old, sqrtw;
+    
+    for(iter = 0; iter < maxIterations; ++iter) {
+        
+        //weights are recalculated every iteration to reweight robust residuals
+        sys.effectiveWeights(sqrtw);
+        sqrtw = sqrtw.cwiseSqrt();
+        calculateStep(sys, sqrtw, levels, h);
+        if(h.norm() <= tolx*(sys.parameter().norm() + tolx)) 
+            return result(sys, hard, levels);
+        
+        //shorten the step until it improves the lexicographic merit
+        x_old = sys.parameter();
+        bool accepted = false;
+        for(int r = 0; r < maxReductions && !accepted; ++r) {
+            
+            sys.parameter() = x_old + h;
+            recalculate();
+            std::vector<Scalar> newMerit = levelErrors(sys, levels);
+            if(better(newMerit, merit)) {
+                merit    = newMerit;
+                accepted = true;
+                recenter(sys, recalculate);
+            }
+            else 
+                h /= 2;
+        }
+        
+        if(!accepted) {
+            sys.parameter() = x_old;
+            recalculate();
+            return result(sys, hard, levels);
+        }
+    }
+    
+    return SolverResult::MaxIterations;
+};
+
+template<typename Kernel>
+std::vector<typename PrioritySolver<Kernel>::Scalar> 
+PrioritySolver<Kernel>::levelErrors(LinearSystem<Kernel>& sys, const std::vector<std::vector<int>>& levels) {
+    
+    std::vector<Scalar> errors;
+    for(const std::vector<int>& level : levels) {
+        Scalar e = 0;
+        for(int row : level) 
+            e += sys.cost(row);
+        errors.push_back(e);
+    }
+    return errors;
+};
+
+template<typename Kernel>
+bool PrioritySolver<Kernel>::better(const std::vector<Scalar>& lhs, const std::vector<Scalar>& rhs) {
+    
+    for(std::size_t i=0; i<lhs.size(); ++i) {
+        const Scalar tol = 1e-12*rhs[i] + tolf*tolf;
+        if(lhs[i] < rhs[i] - tol)
+            return true;
+        if(lhs[i] > rhs[i] + tol)
+            return false;
+    }
+    return false;
+};
+
+template<typename Kernel>
+SolverResult PrioritySolver<Kernel>::result(LinearSystem<Kernel>& sys, bool hard, 
+                                            const std::vector<std::vector<int>>& levels) {
+    
+    if(!hard)
+        return SolverResult::SmallGradient;
+    
+    for(int row : levels.front()) {
+        if(std::abs(sys.residuals()(row)) > tolf)
+            return SolverResult::SmallStep;
+    }
+    return SolverResult::Converged;
+};
+
+template<typename Kernel>
+void PrioritySolver<Kernel>::calculateStep(LinearSystem<Kernel>& sys, const VectorX& sqrtw, 
+                                           const std::vector<std::vector<int>>& levels, VectorX& h) {
+    
+    const int n = sys.parameter().rows();
+    h = VectorX::Zero(n);
+    MatrixX N;   //null space basis of all processed levels
+    
+    for(std::size_t l=0; l<levels.size(); ++l) {
+        
+        const std::vector<int>& level = levels[l];
+        const bool last = l+1 == levels.size();
+        
+        //the weighted linearized equations of this level
+        MatrixX A(level.size(), n);
+        VectorX b(level.size());
+        for(std::size_t i=0; i<level.size(); ++i) {
+            A.row(i) = sqrtw(level[i])*sys.jacobi().row(level[i]);
+            b(i)     = sqrtw(level[i])*sys.residuals()(level[i]);
+        }
+        
+        if(l == 0) {
+            if(!linear.solve(A, b, h))
+                h = -minimalNorm(A, b);
+            if(!last)
+                N = nullSpace(A);
+        }
+        else {
+            //with the step of the previous levels applied, only the remaining freedom is used
+            b += A*h;
+            const MatrixX AN = A*N;
+            h -= N*minimalNorm(AN, b);
+            if(!last)
+                N = N*nullSpace(AN);
+        }
+        
+        if(N.cols() == 0)
+            break;
+    }
+};
+
+template<typename Kernel>
+typename PrioritySolver<Kernel>::VectorX PrioritySolver<Kernel>::minimalNorm(const MatrixX& A, const VectorX& b) {
+    
+    Eigen::CompleteOrthogonalDecomposition<MatrixX> cod(A.rows(), A.cols());
+    cod.setThreshold(rankThreshold);
+    cod.compute(A);
+    return cod.solve(b);
+};
+
+template<typename Kernel>
+typename PrioritySolver<Kernel>::MatrixX PrioritySolver<Kernel>::nullSpace(const MatrixX& A) {
+    
+    Eigen::ColPivHouseholderQR<MatrixX> qr(A.cols(), A.rows());
+    qr.setThreshold(rankThreshold);
+    qr.compute(A.transpose());
+    const MatrixX Q = qr.householderQ();
+    return Q.rightCols(A.cols() - qr.rank());
+};
+
+}//numeric
+}//dcm
+
+#endif //DCM_KERNEL_IMP_H
@@ -20,14 +20,23 @@
 #ifndef DCM_KERNEL_H
 #define DCM_KERNEL_H
 
+#include <map>
+#include <vector>
+#include <cmath>
+#include <numeric>
+#include <functional>
+
 #include <Eigen/Core>
 #include <Eigen/Dense>
 #include <Eigen/Geometry>
+#include <Eigen/Sparse>
 #include <boost/graph/graph_concepts.hpp>
 
 #include "transformation.hpp"
 #include "logging.hpp"
 #include "scheduler.hpp"
+#include "ordering.hpp"
+#include "cholesky.hpp"
 
 namespace dcm {
 namespace numeric {
@@ -70,6 +79,72 @@ struct MatrixEntry {
     };
 };
 
+//robust loss functions to reduce the influence of outliers in least squares solving. Squared is the
+//normal least squares behaviour, all others reduce the weight of residuals bigger than a given scale
+enum class Loss { Squared, Huber, Cauchy, Tukey };
+
+//the parts of the system the constraint equations calculate in a recalculation
+enum class Evaluation { 
+    Full,           //residuals and jacobian
+    Residuals,      //residuals only, the jacobian is left untouched
+    Derivatives     //jacobian only, the residuals are already up to date
+};
+
+/**
+ * @brief Cost of a residual under a robust loss
+ * 
+ * Returns 2*rho(r), which equals r^2 for the squared loss and for small residuals in all other losses. 
+ * 
+ * @param loss The loss function to use
+ * @param scale Residual size from which on the loss reduces the influence
+ * @param r The residual
+ */
+template<typename Scalar>
+Scalar robustCost(Loss loss, Scalar scale, Scalar r) {
+    
+    const Scalar a = std::abs(r);
+    switch(loss) {
+        case Loss::Huber:
+            return (a <= scale) ? r*r : scale*(2*a - scale);
+        case Loss::Cauchy:
+            return scale*scale*std::log1p(r*r/(scale*scale));
+        case Loss::Tukey: {
+            if(a >= scale) 
+                return scale*scale/3.;
+            const Scalar t = 1 - r*r/(scale*scale);
+            return scale*scale/3.*(1 - t*t*t);
+        }
+        default:
+            return r*r;
+    };
+};
+
+/**
+ * @brief Weight of a residual for iteratively reweighted least squares
+ * 
+ * The weight is rho'(r)/r, so that a weighted least squares step approximates a step on the robust cost.
+ * It is 1 for the squared loss and for small residuals in all other losses.
+ */
+template<typename Scalar>
+Scalar robustWeight(Loss loss, Scalar scale, Scalar r) {
+    
+    const Scalar a = std::abs(r);
+    switch(loss) {
+        case Loss::Huber:
+            return (a <= scale) ? 1 : scale/a;
+        case Loss::Cauchy:
+            return 1/(1 + r*r/(scale*scale));
+        case Loss::Tukey: {
+            if(a >= scale) 
+                return 0;
+            const Scalar t = 1 - r*r/(scale*scale);
+            return t*t;
+        }
+        default:
+            return 1;
+    };
+};
+
 template<typename Kernel> 
 struct LinearSystem {
     
@@ -77,30 +152,98 @@ struct LinearSystem {
     typedef Eigen::Matrix<Scalar, Eigen::Dynamic, 1> VectorX;
     typedef Eigen::Matrix<Scalar, Eigen::Dynamic,
                 Eigen::Dynamic>                      MatrixX;
+    typedef Eigen::Map<VectorX, Eigen::Unaligned, 
+                Eigen::InnerStride<>>                ParameterMap;
     
-    LinearSystem(int p, int e) : m_parameterCount(p), m_equationCount(e),
-            m_jacobi(e, p), m_parameters(p),  m_residuals(e) {};
+    LinearSystem(int p, int e) : m_parameterCount(p), m_equationCount(e), m_jacobi(e, p), 
+            m_ownParameters(p), m_parameters(m_ownParameters.data(), p, Eigen::InnerStride<>(1)), 
+            m_residuals(e), m_weights(VectorX::Ones(e)), m_priorities(Eigen::VectorXi::Zero(e)) {};
     
+    /**
+     * @brief Create a system whose parameters live in externally owned memory
+     * 
+     * No parameter storage is allocated, the parameter vector is a view onto \a parameters. Everything 
+     * mapped into the system therefore reads its values directly from that memory and every change of 
+     * the parameters (e.g. the solving result) is written directly into it, no copies are involved. The 
+     * parameters are mapped in the order the equations are initialized, for example a sequence of 
+     * numeric geometries maps the values of every geometry in the layout described in 
+     * geometry::Geometry::fromArray.
+     * 
+     * The caller is responsible for the memory: it must hold \a p values with the given distance 
+     * between consecutive ones, and it must stay valid and must not be moved for the whole lifetime 
+     * of this system and all equations initialized with it.
+     * 
+     * @param parameters Externally owned memory holding the parameter values
+     * @param p Number of parameters
+     * @param e Number of equations
+     * @param stride Distance between two consecutive parameters in the memory, in scalars
+     */
+    LinearSystem(Scalar* parameters, int p, int e, int stride = 1) : m_parameterCount(p), m_equationCount(e),
+            m_jacobi(e, p), m_parameters(parameters, p, Eigen::InnerStride<>(stride)), m_residuals(e),
+            m_weights(VectorX::Ones(e)), m_priorities(Eigen::VectorXi::Zero(e)) {};
+            
+    //the parameter map may point to our own storage, a copy would alias it
+    LinearSystem(const LinearSystem&) = delete;
+    LinearSystem& operator=(const LinearSystem&) = delete;
+    
+    /**
+     * @brief Use a custom numbering for parameters and residuals
+     * 
+     * By default parameters and residuals are numbered in the order they are mapped. A fill reducing 
+     * ordering (see ordering::nestedDissection) can be set here, it must be set before anything is 
+     * mapped. Each permutation gives the new index for every entry in mapping order, an empty permutation 
+     * keeps the mapping order.
+     */
+    void setOrdering(const std::vector<int>& parameters, const std::vector<int>& residuals) {
+        dcm_assert(m_parameterOffset == -1 && m_residualOffset == -1);
+        dcm_assert(parameters.empty() || parameters.size() == m_parameterCount);
+        dcm_assert(residuals.empty()  || residuals.size()  == m_equationCount);
+        m_parameterOrder = parameters;
+        m_residualOrder  = residuals;
+    };
+    
+    /**
+     * @brief Describe the parameter blocks and their coupling
+     * 
+     * Every geometry or cluster is a block of consecutive parameters, the adjacency gives the blocks 
+     * coupled by equations (the constraint graph). The solvers use it to choose a linear backend and to 
+     * run block sparse factorizations, an empty structure is allowed and treats the system as unstructured.
+     */
+    void setBlockStructure(const std::vector<int>& sizes, const std::vector<std::vector<int>>& adjacency) {
+        dcm_assert(sizes.size() == adjacency.size());
+        dcm_assert(std::accumulate(sizes.begin(), sizes.end(), 0) == m_parameterCount || sizes.empty());
+        m_blockSizes     = sizes;
+        m_blockAdjacency = adjacency;
+    };
+    
+    const std::vector<int>& blockSizes() const {return m_blockSizes;};
+    const std::vector<std::vector<int>>& blockAdjacency() const {return m_blockAdjacency;};
     
     VectorEntry<Kernel> mapParameter() {
-        Scalar* s = &m_parameters(++m_parameterOffset);
-        return {m_parameterOffset, s};
+        const int index = parameterIndex(++m_parameterOffset);
+        return {index, &m_parameters(index)};
     };                
                
     std::vector<VectorEntry<Kernel>> mapParameter(Scalar*& s) {
-        s = &m_parameters(++m_parameterOffset);
+        const int index = parameterIndex(++m_parameterOffset);
+        s = &m_parameters(index);
         std::vector<VectorEntry<Kernel>> result(1);
-        result[0] = {m_parameterOffset, s};
+        result[0] = {index, s};
         return result;
     };
 
     template<typename Derived>
     std::vector<VectorEntry<Kernel>> mapParameter(Eigen::Map<Derived>& map) {
-        new(&map) Eigen::Map<Derived>(&m_parameters(++m_parameterOffset));
+        //the map expects consecutive values
+        dcm_assert(m_parameters.innerStride() == 1);
+        const int index = parameterIndex(++m_parameterOffset);
+        new(&map) Eigen::Map<Derived>(&m_parameters(index));
         
         std::vector<VectorEntry<Kernel>> result(map.rows());
-        for (int i = 0; i < map.rows(); ++i)
-            result[i] = {m_parameterOffset + i, &m_parameters(m_parameterOffset + i)};
+        for (int i = 0; i < map.rows(); ++i) {
+            dcm_assert(parameterIndex(m_parameterOffset + i) == index + i);
+            result[i] = {index + i, &m_parameters(index + i)};
+        }
 
         //minus one as we increase the parameter offset already in this function
         m_parameterOffset+= (map.rows()-1);
@@ -109,13 +252,14 @@ struct LinearSystem {
     };
     
     VectorEntry<Kernel> mapResidual(Scalar*& s) {
-        s = &m_residuals(++m_residualOffset);
-        return {m_residualOffset, s};
+        const int index = residualIndex(++m_residualOffset);
+        s = &m_residuals(index);
+        return {index, s};
     };
     
     VectorEntry<Kernel> mapResidual() {
-        Scalar* s = &m_residuals(++m_residualOffset);
-        return {m_residualOffset, s};
+        const int index = residualIndex(++m_residualOffset);
+        return {index, &m_residuals(index)};
     };
     
     MatrixEntry<Kernel> mapJacobi(int row, int col, Scalar*& s) {
@@ -136,17 +280,145 @@ struct LinearSystem {
        return m_jacobi(row, col);  
     };
     
+    /**
+     * @brief Weight a residual for least squares solving
+     * 
+     * All residuals are hard equations with weight 1 by default. Residuals with a priority greater than 
+     * zero are soft: the solver only minimizes them in the weighted least squares sense, and only as far 
+     * as all residuals with lower priority numbers are not affected. Priority 0 are the hard equations 
+     * which are always satisfied first.
+     * 
+     * @param row The residual index as returned by \ref mapResidual
+     * @param weight Factor applied to the squared residual, must be positive
+     * @param priority 0 for hard equations, greater numbers for soft equations of decreasing importance
+     */
+    void setResidualWeight(int row, Scalar weight, int priority) {
+        dcm_assert(weight > 0 && priority >= 0);
+        m_weights(row)    = weight;
+        m_priorities(row) = priority;
+    };
+    
+    bool hasSoftResiduals() {
+        return (m_priorities.array() > 0).any();
+    };
+    
+    /**
+     * @brief Use a robust loss function for a residual
+     * 
+     * The residual then gets reweighted in every solver iteration depending on its current size, which 
+     * limits the influence of outliers. 
+     * 
+     * @param row The residual index as returned by \ref mapResidual
+     * @param loss The loss function
+     * @param scale Residual size from which on the residual is considered as outlier, must be positive
+     */
+    void setResidualLoss(int row, Loss loss, Scalar scale) {
+        dcm_assert(scale > 0);
+        if(m_losses.empty())
+            m_losses.resize(m_residuals.rows(), std::make_pair(Loss::Squared, Scalar(1)));
+        
+        m_losses[row] = std::make_pair(loss, scale);
+    };
+    
+    bool hasRobustResiduals() {
+        return !m_losses.empty();
+    };
+    
+    /**
+     * @brief The residual weights including the robust reweighting for the current residuals
+     * 
+     * Every weight is the user weight times the iteratively reweighted least squares weight of the loss.
+     * Without robust residuals this is the same as \ref weights.
+     */
+    void effectiveWeights(VectorX& w) {
+        
+        w = m_weights;
+        for(std::size_t i=0; i<m_losses.size(); ++i)
+            w(i) *= robustWeight(m_losses[i].first, m_losses[i].second, m_residuals(i));
+    };
+    
+    //weighted robust cost of a single residual, the sum of those is minimized by the solvers
+    Scalar cost(int row) {
+        
+        if(m_losses.empty())
+            return m_weights(row)*m_residuals(row)*m_residuals(row);
+        
+        return m_weights(row)*robustCost(m_losses[row].first, m_losses[row].second, m_residuals(row));
+    };
+    
+    Scalar cost() {
+        
+        Scalar c = 0;
+        for(int i=0; i<m_residuals.rows(); ++i)
+            c += cost(i);
+        return c;
+    };
+    
+    /**
+     * @brief Restrict the evaluation of the constraint equations
+     * 
+     * While not set to Full, the constraint equations calculate only the requested part and leave the 
+     * other one untouched. This allows to check cheaply if a system is already solved, and to complete
+     * such a check with the jacobian afterwards without calculating the residuals again.
+     */
+    void setEvaluation(Evaluation evaluation) {
+        m_evaluation = evaluation;
+    };
+    
+    const Evaluation& evaluation() {
+        return m_evaluation;
+    };
+    
+    /**
+     * @brief Register a local parametrization which needs to be recentered during solving
+     * 
+     * Parametrizations which only describe the neighbourhood of a reference well, like the tangent space of
+     * a direction, move their reference to the current value when called. The nonlinear solvers do this
+     * after every accepted step and evaluate the jacobian again afterwards, the residuals stay unchanged.
+     */
+    void addRecentering(const std::function<void()>& recenter) {
+        m_recentering.push_back(recenter);
+    };
+    
+    bool hasRecentering() {
+        return !m_recentering.empty();
+    };
+    
+    void recenter() {
+        for(auto& recenter : m_recentering)
+            recenter();
+    };
+    
     //access the vectors and matrices
-    VectorX& parameter() {return m_parameters;};
+    ParameterMap& parameter() {return m_parameters;};
     VectorX& residuals() {return m_residuals;};
     MatrixX& jacobi()    {return m_jacobi;};    
+    VectorX& weights()   {return m_weights;};
+    Eigen::VectorXi& priorities() {return m_priorities;};
     
 private:
+    int parameterIndex(int offset) {
+        return m_parameterOrder.empty() ? offset : m_parameterOrder[offset];
+    };
+    
+    int residualIndex(int offset) {
+        return m_residualOrder.empty() ? offset : m_residualOrder[offset];
+    };
+    
     int m_parameterCount, m_equationCount;
     int m_parameterOffset = -1, m_residualOffset  = -1;
-    VectorX m_parameters;
-    VectorX m_residuals;
-    MatrixX m_jacobi;
+    std::vector<int> m_parameterOrder, m_residualOrder;
+    MatrixX         m_jacobi;
+    VectorX         m_ownParameters;  //unused if the parameters are stored externally
+    ParameterMap    m_parameters;
+    VectorX         m_residuals;
+    VectorX         m_weights;
+    Eigen::VectorXi m_priorities;
+    std::vector<std::pair<Loss, Scalar>> m_losses; //empty if no residual uses a robust loss
+    std::vector<int>                     m_blockSizes;
+    std::vector<std::vector<int>>        m_blockAdjacency;
+    Evaluation                           m_evaluation = Evaluation::Full;
+    std::vector<std::function<void()>>   m_recentering;
 };
 
 
@@ -199,7 +471,199 @@ protected:
 
 };
     
-//the standart solverS
+//available solvers for the linear subproblem of the nonlinear solvers
+enum class LinearBackend {
+    Automatic,              //chosen by the BackendPolicy from size and structure of the system
+    FixedDense,             //stack allocated dense normal equations, for single clusters
+    DenseLDLT,              //dense normal equations
+    DenseQR,                //rank revealing QR of the jacobian, the most robust but slowest dense backend
+    SparseDirect,           //sparse cholesky, supernodal on the parameter blocks if they are known
+    DomainDecomposition,    //concurrent sparse cholesky of balanced subdomains and their separator
+    MatrixFree              //preconditioned conjugate gradients, the normal matrix is never formed
+};
+
+/**
+ * @brief Picks the cheapest linear backend for a system
+ * 
+ * A model can contain thousands of tiny cluster components together with a single huge one, hence the 
+ * backend is chosen for every system separately. Tiny systems use stack allocated fixed size matrices, 
+ * small ones dense factorizations and medium ones a sparse direct solver. Large systems with a known
+ * block structure are split into subdomains which are factorized concurrently, as a single big 
+ * component gains nothing from the component splitting. Huge systems are solved iteratively as a 
+ * direct factorization would need too much memory. Dense systems with many nonzeros skip the sparse 
+ * backends as their overhead does not pay off.
+ * 
+ * All thresholds are parameter counts and can be tuned, setting \a backend to anything but Automatic 
+ * overrides the selection completely.
+ * 
+ * Note that \ref LinearSystem stores its jacobian densely, hence counting the nonzeros of a system is
+ * quadratic in its size. The sparse and iterative backends save the dense factorization, not the dense
+ * storage of the jacobian.
+ */
+struct BackendPolicy {
+    
+    static const int MaxFixedSize = 6;
+    
+    LinearBackend backend   = LinearBackend::Automatic;
+    int           fixedLimit  = MaxFixedSize;
+    int           denseLimit  = 300;
+    int           sparseLimit = 20000;
+    int           decompositionLimit = 5000;  //block structured systems above are decomposed
+    double        denseFill   = 0.25;     //jacobian fill above which a system counts as dense
+    
+    /**
+     * @brief The backend for a system with the given structure
+     * 
+     * @param parameters The number of parameters
+     * @param equations The number of residuals
+     * @param nonzeros The number of nonzero jacobian entries
+     * @param structured True if the parameter block structure is known
+     */
+    LinearBackend select(int parameters, int equations, long nonzeros, bool structured = false) const {
+        
+        if(backend != LinearBackend::Automatic)
+            return backend;
+        
+        if(parameters <= std::min(fixedLimit, int(MaxFixedSize)))
+            return LinearBackend::FixedDense;
+        if(parameters <= denseLimit)
+            return LinearBackend::DenseLDLT;
+        
+        const double fill = double(nonzeros)/(double(parameters)*std::max(equations, 1));
+        if(parameters <= sparseLimit) {
+            if(fill > denseFill)
+                return LinearBackend::DenseLDLT;
+            return (structured && parameters > decompositionLimit) ? LinearBackend::DomainDecomposition 
+                                                                   : LinearBackend::SparseDirect;
+        }
+
+        return LinearBackend::MatrixFree;
+    };
+    
+    template<typename Kernel>
+    LinearBackend select(LinearSystem<Kernel>& sys) const {
+        
+        if(backend != LinearBackend::Automatic)
+            return backend;
+        
+        return select(sys.jacobi().cols(), sys.jacobi().rows(), (sys.jacobi().array() != 0).count(), 
+                      !sys.blockSizes().empty());
+    };
+};
+
+/**
+ * @brief Solves the linear least squares subproblem min |J h + F| with the backend of a policy
+ * 
+ * The backend is chosen once per system in \ref analyze, afterwards \ref solve can be called for every
+ * new jacobian with the same structure. All normal equation based backends add a tiny relative damping 
+ * when a factorization needs definiteness, rank deficient (underconstrained) systems therefore get a
+ * solution close to the minimal norm one.
+ * 
+ * The sparse backends convert the dense jacobian in every \ref solve, which costs a scan over all of its
+ * entries. This is cheap compared to a dense factorization of the same size but still quadratic.
+ */
+template<typename Kernel>
+struct LinearSolver {
+    
+    typedef typename Kernel::Scalar                               Scalar;
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, 1>              VectorX;
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> MatrixX;
+    typedef Eigen::SparseMatrix<Scalar>                           SparseMatrix;
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor, 
+                          BackendPolicy::MaxFixedSize, BackendPolicy::MaxFixedSize>  FixedMatrix;
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, 1, Eigen::ColMajor, 
+                          BackendPolicy::MaxFixedSize, 1>                            FixedVector;
+    
+    BackendPolicy policy;
+    Scalar        damping = 1e-12;      //relative to the largest diagonal entry of the normal matrix
+    Scalar        tolerance = 1e-12;    //relative residual for the iterative backend
+    bool          parallel = true;      //factorize independent blocks concurrently
+    
+    void analyze(LinearSystem<Kernel>& sys);
+    
+    LinearBackend backend() const {
+        return m_backend;
+    };
+    
+    /**
+     * @brief Computes the least squares step h for J h = -F
+     * 
+     * @return bool False if the backend failed
+     */
+    bool solve(const MatrixX& J, const VectorX& F, VectorX& h);
+    
+protected:
+    bool solveSparse(const MatrixX& J, const VectorX& F, VectorX& h);
+    
+    //conjugate gradients on the normal equations with jacobi preconditioner, only products with J and
+    //its transpose are needed. Starting from zero it converges to the minimal norm solution
+    bool solveIterative(const MatrixX& J, const VectorX& F, VectorX& h);
+    
+    LinearBackend               m_backend = LinearBackend::DenseQR;
+    bool                        m_blocks  = false;
+    BlockCholesky<Kernel>       m_cholesky;
+    DomainDecomposition<Kernel> m_domains;
+};
+
+//recalculates a system with a restricted evaluation mode
+template<typename Kernel, typename Functor>
+void evaluate(LinearSystem<Kernel>& sys, Functor& recalculate, Evaluation evaluation) {
+    
+    sys.setEvaluation(evaluation);
+    try {
+        recalculate();
+    }
+    catch(...) {
+        sys.setEvaluation(Evaluation::Full);
+        throw;
+    }
+    sys.setEvaluation(Evaluation::Full);
+};
+
+//moves all local parametrizations to the current parameters, which only changes the jacobian
+template<typename Kernel, typename Functor>
+void recenter(LinearSystem<Kernel>& sys, Functor& recalculate) {
+    
+    if(!sys.hasRecentering())
+        return;
+    
+    sys.recenter();
+    evaluate(sys, recalculate, Evaluation::Derivatives);
+};
+
+//possible outcomes of a nonlinear solving run
+enum class SolverResult { 
+    Converged,      //residual is below the tolerance
+    SmallGradient,  //a (least squares) minimum was reached but the residual is not zero
+    SmallStep,      //no progress possible anymore
+    MaxIterations   //iteration limit reached without convergence
+};
+
+/**
+ * @brief Powell's dogleg trust region solver
+ * 
+ * Minimizes the weighted squared residual sum of a \ref LinearSystem. Every residual row and its 
+ * jacobian row are scaled by the square root of the residual weight, hence all equations are solved in 
+ * the weighted least squares sense. Priorities are not distinguished, use \ref PrioritySolver if soft 
+ * equations must not disturb hard ones. Residuals with a robust loss are handled by iteratively 
+ * reweighted least squares: the weights are updated after every accepted step, while the jacobian 
+ * structure and hence the factorization stays the same. Convergence is always judged by the residuals 
+ * scaled with the plain weights, as a robust loss may ignore residuals that are still far from zero.
+ * 
+ * Badly scaled systems are handled by equilibrating the jacobian instead of rescaling the geometry. The
+ * trust region is defined in variables scaled by the column norms of the jacobian, which are updated
+ * after every accepted step by keeping the largest norm seen so far. The result is therefore invariant 
+ * to the unit of every single parameter. If the linearized equations are consistent (not more rows than
+ * columns) the Gauss-Newton step is additionally computed from the row equilibrated jacobian by every 
+ * backend, which does not change the step but improves the conditioning of the factorization.
+ * 
+ * The Gauss-Newton step is computed by the linear backend the \ref BackendPolicy of \a linear selects
+ * for the system. If the backend fails the rank revealing QR is used as fallback.
+ * 
+ * The system needs to be recalculated for every new parameter vector. This is done by the \a recalculate 
+ * functor given to \ref solve, which needs to update the residuals and the jacobi of the system from its 
+ * current parameters.
+ */
 template<typename Kernel>
 struct Dogleg {
 
@@ -207,27 +671,182 @@ struct Dogleg {
     dcm_logger log;
 #endif
 
-    typedef typename Kernel::Scalar Scalar;
-    Scalar tolg, tolx, delta, nu, g_inf, fx_inf, err, time;
-    Kernel* m_kernel;
-    int iter, stop, reduce, unused, counter;
-    Eigen::Matrix<Scalar, Eigen::Dynamic, 1> h_dl, F_old, g;
-    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> J_old;
-
-    Dogleg(Kernel* k);
-    Dogleg();
-/*
-    void setKernel(Kernel* k);
+    typedef typename Kernel::Scalar                               Scalar;
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, 1>              VectorX;
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> MatrixX;
+    
+    Scalar tolg = 1e-40, tolx = 1e-20, tolf = 1e-10;
+    Scalar delta = 5;       //initial trust region radius
+    int    maxIterations = 1000;
+    bool   equilibrate = true;
+    bool   precheck = true;     //skip all setup if the residuals are already within tolerance
+    
+    LinearSolver<Kernel> linear;
+    
+    //statistics of the last solving run
+    int    iter = 0;
+    Scalar err  = 0;
 
-    template <typename Derived, typename Derived2, typename Derived3, typename Derived4>
-    void calculateStep(const Eigen::MatrixBase<Derived>& g, const Eigen::MatrixBase<Derived3>& jacobi,
-                       const Eigen::MatrixBase<Derived4>& residual, Eigen::MatrixBase<Derived2>& h_dl,
-                       const double delta);
+    SolverResult solve(LinearSystem<Kernel>& sys, const std::function<void()>& recalculate);
+    
+protected:
+    //the same convergence criterion as in the iteration, but without any jacobian evaluation
+    bool isSatisfied(LinearSystem<Kernel>& sys, const std::function<void()>& recalculate);
+    
+    //the weighted residuals of the current state are within tolerance. Robust weights are not used, 
+    //tukey gives zero weight to every residual outside its scale
+    bool isConverged(LinearSystem<Kernel>& sys);
+    
+    //workspace of the solving run, kept as members so that solving many systems with the same solver
+    //object does not allocate again for every system of the same size
+    VectorX sqrtw, D, F, g, z_dl, h_dl, h_gn, x_old, R, Fr;
+    MatrixX J, Js, Jr;
+    
+    //column scaling, monotonically increasing to keep the trust region shape stable (Moré)
+    void updateScaling(const MatrixX& J, VectorX& D, bool init);
+    
+    void calculateStep(const VectorX& g, const MatrixX& J, const VectorX& F, VectorX& h_dl, 
+                       const Scalar radius);
+};
 
-    int solve(typename Kernel::MappedEquationSystem& sys);
+/**
+ * @brief Solver for hard equations combined with soft weighted ones
+ * 
+ * Residuals are grouped by their priority (see \ref LinearSystem::setResidualWeight). The hard equations 
+ * (priority 0) are treated as constraints, the soft ones are minimized in the weighted least squares 
+ * sense subject to them. With more than one soft priority the levels are handled lexicographically: 
+ * every level is only allowed to use the freedom left by all more important levels.
+ * 
+ * Each iteration computes a hierarchical Gauss-Newton step: the weighted linearized equations of one 
+ * level are solved in the null space of the jacobians of all previous levels, and the null space is 
+ * shrunk afterwards. Steps are shortened until the residuals improve lexicographically. Robust losses are
+ * handled by reweighting the residuals at the start of every iteration.
+ * 
+ * The most important level is solved by the backend of \a linear, exactly like a \ref Dogleg step. 
+ * Only if further levels follow, its null space is computed from a rank revealing QR decomposition. The 
+ * projected equations of the later levels are solved by a complete orthogonal decomposition, which gives
+ * the minimal norm solution inside the remaining freedom.
+ */
+template<typename Kernel>
+struct PrioritySolver {
+    
+    typedef typename Kernel::Scalar                               Scalar;
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, 1>              VectorX;
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> MatrixX;
+    
+    Scalar tolx = 1e-12, tolf = 1e-10;
+    Scalar rankThreshold = 1e-10;   //relative pivot threshold for the rank decisions
+    int    maxIterations = 200, maxReductions = 30;
+    bool   precheck = true;         //skip all setup if all residuals are already within tolerance
+    
+    LinearSolver<Kernel> linear;
+    
+    int iter = 0;
+    
+    SolverResult solve(LinearSystem<Kernel>& sys, const std::function<void()>& recalculate);
+    
+protected:
+    std::vector<Scalar> levelErrors(LinearSystem<Kernel>& sys, const std::vector<std::vector<int>>& levels);
+    
+    //lexicographic comparison, the first level with a significant difference decides
+    bool better(const std::vector<Scalar>& lhs, const std::vector<Scalar>& rhs);
+    
+    SolverResult result(LinearSystem<Kernel>& sys, bool hard, const std::vector<std::vector<int>>& levels);
+    
+    void calculateStep(LinearSystem<Kernel>& sys, const VectorX& sqrtw, 
+                       const std::vector<std::vector<int>>& levels, VectorX& h);
+    
+    //minimal norm least squares solution of A x = b
+    VectorX minimalNorm(const MatrixX& A, const VectorX& b);
+    
+    //orthonormal basis of the null space of A from the QR decomposition of its transpose
+    MatrixX nullSpace(const MatrixX& A);
+};
 
-    template<typename Functor>
-    int solve(typename Kernel::MappedEquationSystem& sys, Functor& rescale);*/
+/**
+ * @brief Solves many independent systems concurrently
+ * 
+ * Many small systems are dominated by the fixed cost of a solving run rather than by the math. The batch 
+ * solver distributes the added systems over the worker threads, every worker uses its own copy of the 
+ * nonlinear solver for all systems it processes. As the solvers keep their buffers between runs, systems
+ * of similar size do not allocate anymore after the first few of them. The worker solvers are kept 
+ * between batches as well. The solvers may use the parallel linear backends, a worker never starts 
+ * another system while it waits for the nested tasks of its current one.
+ * 
+ * The worker solvers are created as copies of \ref prototype, changes of the prototype settings are 
+ * only picked up by workers created after \ref reset.
+ * 
+ * @tparam Solver the nonlinear solver used for every system
+ */
+template<typename Kernel, template<class> class Solver = Dogleg>
+struct BatchSolver {
+    
+    typedef Solver<Kernel> SolverType;
+    
+    struct Result {
+        SolverResult result;
+        int          iterations;
+    };
+    
+    SolverType prototype;
+    int        grainsize = 1;   //number of systems processed by a single task
+    
+    BatchSolver() : m_workers([this]() {return prototype;}) {};
+    BatchSolver(const BatchSolver&) = delete;
+    
+    /**
+     * @brief Adds a system to the batch
+     * 
+     * The system and everything accessed by the recalculate functor must stay valid until the batch is 
+     * solved and must not be shared with other systems of the batch.
+     */
+    void add(LinearSystem<Kernel>& sys, const std::function<void()>& recalculate) {
+        m_jobs.push_back(Job{&sys, recalculate});
+    };
+    
+    std::size_t size() const {
+        return m_jobs.size();
+    };
+    
+    /**
+     * @brief Solves all added systems and empties the batch
+     * 
+     * @return The results in the order the systems were added
+     */
+    std::vector<Result> solve() {
+        
+        std::vector<Result> results(m_jobs.size());
+        shedule::for_each_with_state(int(m_jobs.size()), m_workers, [&](int i, SolverType& solver) {
+            results[i].result     = solver.solve(*m_jobs[i].system, m_jobs[i].recalculate);
+            results[i].iterations = solver.iter;
+        }, grainsize);
+        
+        m_jobs.clear();
+        return results;
+    };
+    
+    /**
+     * @brief Drops all worker solvers together with their buffers
+     */
+    void reset() {
+        m_workers.clear();
+    };
+    
+    /**
+     * @brief Number of worker solvers created so far
+     */
+    std::size_t workers() const {
+        return m_workers.size();
+    };
+    
+private:
+    struct Job {
+        LinearSystem<Kernel>* system;
+        std::function<void()> recalculate;
+    };
+    
+    std::vector<Job>                   m_jobs;
+    shedule::WorkerStates<SolverType>  m_workers;
 };
 
 struct DummyKernel : public numeric::KernelBase {
@@ -252,7 +871,26 @@ private:
 }//dcm
 
 #ifndef DCM_EXTERNAL_CORE
-//#include "imp/kernel_imp.hpp"
+#include "imp/kernel_imp.hpp"
+#endif
+
+//the numeric core for the standard kernel is explicitly instantiated in the opendcm_core library, clients
+//only declare the instantiations and link the optimized object code. Member templates are not covered by 
+//the class instantiation and are listed for the common argument types
+#define DCM_EXTERNAL_NUMERIC( Prefix, Kernel )\
+    Prefix template struct dcm::numeric::LinearSystem<Kernel>; \
+    Prefix template std::vector<dcm::numeric::VectorEntry<Kernel>> dcm::numeric::LinearSystem<Kernel>::mapParameter( \
+        Eigen::Map<Eigen::Matrix<Kernel::Scalar, 2, 1>>&); \
+    Prefix template std::vector<dcm::numeric::VectorEntry<Kernel>> dcm::numeric::LinearSystem<Kernel>::mapParameter( \
+        Eigen::Map<Eigen::Matrix<Kernel::Scalar, 3, 1>>&); \
+    Prefix template struct dcm::numeric::LinearSolver<Kernel>; \
+    Prefix template struct dcm::numeric::Dogleg<Kernel>; \
+    Prefix template struct dcm::numeric::PrioritySolver<Kernel>; \
+    Prefix template class dcm::numeric::BlockCholesky<Kernel>; \
+    Prefix template class dcm::numeric::DomainDecomposition<Kernel>;
+
+#ifdef DCM_EXTERNAL_CORE
+DCM_EXTERNAL_NUMERIC( extern, dcm::Eigen3Kernel<double> )
 #endif
 
 #endif //GCM_KERNEL_H
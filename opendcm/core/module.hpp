@@ -93,22 +93,20 @@ struct remove_base {
 template<typename Final, typename MathKernel>
 struct ModuleCoreInit {
 
-    ModuleCoreInit() : m_graph(NULL)
-#ifdef DCM_USE_LOGGING
-        , sink(init_log())
-#endif
-    {};
+    //everything expensive is created on first use, an unused system costs nearly nothing
+    ModuleCoreInit() : m_graph(NULL) {};
 
     ~ModuleCoreInit() {
 #ifdef DCM_USE_LOGGING
-        stop_log(sink);
+        if(sink)
+            stop_log(sink);
 #endif
     };
 
 #ifdef DCM_USE_LOGGING
     template<typename Expr>
     void setLoggingFilter(const Expr& ex) {
-        sink->set_filter(ex);
+        getSink()->set_filter(ex);
     }
 #endif
 
@@ -134,13 +132,24 @@ public:
 #endif
     //ensure that the correct graph type is used by not allowing anyone to set the graph pointer
     std::shared_ptr<graph::AccessGraphBase> getGraph() {
-        if(!m_graph)
+        if(!m_graph) {
             m_graph = std::make_shared<typename Final::Graph>();
-
+#ifdef DCM_USE_LOGGING
+            getSink();
+#endif
+        }
         return m_graph;
     };
     
 private:
+#ifdef DCM_USE_LOGGING
+    boost::shared_ptr< sink_t >& getSink() {
+        if(!sink)
+            sink = init_log();
+        return sink;
+    };
+#endif
+
     std::shared_ptr<graph::AccessGraphBase> m_graph;
 #ifdef DCM_USE_LOGGING
     boost::shared_ptr< sink_t > sink;
@@ -0,0 +1,565 @@
+/*
+    openDCM, dimensional constraint manager
+    Copyright (C) 2015  Stefan Troeger <stefantroeger@gmx.net>
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along
+    with this library; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef DCM_ORDERING_H
+#define DCM_ORDERING_H
+
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <utility>
+#include <cstdlib>
+
+#include "defines.hpp"
+
+namespace dcm {
+namespace numeric {
+
+/**
+ * @brief Fill reducing orderings derived from the constraint graph
+ *
+ * The sparsity of the normal equations is fully determined by the constraint graph: every geometry or
+ * cluster is a dense block of parameters (6 for a cluster) and every constraint couples the blocks it
+ * connects. Ordering the graph vertices instead of the assembled matrix entries therefore treats all
+ * blocks as supernodes and is much cheaper than a generic ordering on the matrix.
+ *
+ * The graph is given as adjacency list where every vertex is a parameter block, vertices are identified
+ * by their position in the list. An ordering is a vector of vertices in elimination order.
+ */
+namespace ordering {
+
+namespace detail {
+
+//breath first search restricted to vertices with the given part id. Returns the vertices grouped
+//into their distance levels from start
+inline std::vector<std::vector<int>> levelStructure(const std::vector<std::vector<int>>& adjacency,
+                                                    const std::vector<int>& part, int id, int start,
+                                                    std::vector<int>& visited, int stamp) {
+
+    std::vector<std::vector<int>> levels(1, std::vector<int>(1, start));
+    visited[start] = stamp;
+
+    while(true) {
+        std::vector<int> next;
+        for(int v : levels.back()) {
+            for(int n : adjacency[v]) {
+                if(part[n] == id && visited[n] != stamp) {
+                    visited[n] = stamp;
+                    next.push_back(n);
+                }
+            }
+        }
+        if(next.empty())
+            break;
+
+        levels.push_back(std::move(next));
+    }
+    return levels;
+};
+
+struct Dissector {
+
+    const std::vector<std::vector<int>>& m_adjacency;
+    std::vector<int>  m_part, m_visited;
+    std::vector<int>& m_order;
+    int m_leafSize, m_nextId = 0, m_stamp = 0;
+
+    Dissector(const std::vector<std::vector<int>>& adj, std::vector<int>& order, int leafSize)
+        : m_adjacency(adj), m_part(adj.size(), -1), m_visited(adj.size(), -1), m_order(order),
+          m_leafSize(leafSize) {};
+
+    void dissect(std::vector<int> vertices) {
+
+        if(vertices.size() <= m_leafSize) {
+            m_order.insert(m_order.end(), vertices.begin(), vertices.end());
+            return;
+        }
+
+        const int id = m_nextId++;
+        for(int v : vertices)
+            m_part[v] = id;
+
+        //a pseudo peripheral vertex gives a deep level structure and therefore small levels
+        std::vector<std::vector<int>> levels = levelStructure(m_adjacency, m_part, id, vertices.front(),
+                                                              m_visited, ++m_stamp);
+        levels = levelStructure(m_adjacency, m_part, id, levels.back().front(), m_visited, ++m_stamp);
+
+        std::vector<int> first, second, separator;
+
+        //disconnected parts are independent, no separator needed
+        int reached = 0;
+        for(auto& level : levels)
+            reached += level.size();
+
+        if(reached < vertices.size()) {
+            for(int v : vertices)
+                (m_visited[v] == m_stamp ? first : second).push_back(v);
+        }
+        else if(levels.size() < 3) {
+            m_order.insert(m_order.end(), vertices.begin(), vertices.end());
+            return;
+        }
+        else {
+            //split at the level which halves the vertex count
+            int count = levels[0].size(), middle = 1;
+            for(; middle < levels.size()-2; ++middle) {
+                if(2*(count + levels[middle].size()) >= vertices.size())
+                    break;
+                count += levels[middle].size();
+            }
+
+            for(int l = 0; l < levels.size(); ++l) {
+                if(l < middle)
+                    first.insert(first.end(), levels[l].begin(), levels[l].end());
+                else if(l > middle)
+                    second.insert(second.end(), levels[l].begin(), levels[l].end());
+            }
+
+            //only middle level vertices with a neighbour in the second part are needed to separate
+            for(int v : levels[middle])
+                m_part[v] = -2;
+            for(int v : second)
+                m_part[v] = -3;
+
+            for(int v : levels[middle]) {
+                bool needed = std::any_of(m_adjacency[v].begin(), m_adjacency[v].end(),
+                                          [&](int n) {return m_part[n] == -3;});
+                (needed ? separator : first).push_back(v);
+            }
+        }
+
+        //no progress, e.g. for a complete graph
+        if(first.empty() || second.empty()) {
+            m_order.insert(m_order.end(), vertices.begin(), vertices.end());
+            return;
+        }
+
+        dissect(std::move(first));
+        dissect(std::move(second));
+        m_order.insert(m_order.end(), separator.begin(), separator.end());
+    };
+};
+
+} //detail
+
+/**
+ * @brief Nested dissection ordering of the constraint graph
+ *
+ * The graph is recursively split by small vertex separators found from breadth first level structures.
+ * The separators are eliminated last, so that both halves do not create fill between each other. Parts
+ * with at most \a leafSize vertices are not split further.
+ *
+ * @param adjacency The neighbours of every vertex, must be symmetric
+ * @param leafSize Size of parts which are not dissected anymore
+ * @return std::vector<int> The vertices in elimination order
+ */
+inline std::vector<int> nestedDissection(const std::vector<std::vector<int>>& adjacency, int leafSize = 8) {
+
+    std::vector<int> order;
+    order.reserve(adjacency.size());
+
+    std::vector<int> vertices(adjacency.size());
+    for(int i=0; i<vertices.size(); ++i)
+        vertices[i] = i;
+
+    detail::Dissector(adjacency, order, std::max(leafSize, 1)).dissect(std::move(vertices));
+    dcm_assert(order.size() == adjacency.size());
+    return order;
+};
+
+/**
+ * @brief Permutation of the parameters for a given vertex ordering
+ *
+ * The parameters are expected to be mapped block by block in vertex order, as done when the geometries
+ * are initialized one after another. The result can directly be used as \ref LinearSystem parameter
+ * ordering. The parameters of a block stay consecutive.
+ *
+ * @param order The vertex elimination order
+ * @param blockSizes The number of parameters of every vertex
+ * @return std::vector<int> The new index for every parameter in mapping order
+ */
+inline std::vector<int> parameterPermutation(const std::vector<int>& order, const std::vector<int>& blockSizes) {
+
+    dcm_assert(order.size() == blockSizes.size());
+
+    std::vector<int> blockStart(blockSizes.size()), newStart(blockSizes.size());
+    int total = 0;
+    for(int i=0; i<blockSizes.size(); ++i) {
+        blockStart[i] = total;
+        total += blockSizes[i];
+    }
+
+    int position = 0;
+    for(int v : order) {
+        newStart[v] = position;
+        position += blockSizes[v];
+    }
+
+    std::vector<int> permutation(total);
+    for(int i=0; i<blockSizes.size(); ++i) {
+        for(int j=0; j<blockSizes[i]; ++j)
+            permutation[blockStart[i]+j] = newStart[i]+j;
+    }
+    return permutation;
+};
+
+/**
+ * @brief Permutation of the equations for a given vertex ordering
+ *
+ * Every equation is sorted by the position of the earliest eliminated vertex it connects, which gives
+ * the jacobi the same block structure as the parameter ordering.
+ *
+ * @param order The vertex elimination order
+ * @param equations The two vertices every equation connects, in mapping order
+ * @return std::vector<int> The new index for every equation in mapping order
+ */
+inline std::vector<int> equationPermutation(const std::vector<int>& order,
+                                            const std::vector<std::pair<int,int>>& equations) {
+
+    std::vector<int> position(order.size());
+    for(int i=0; i<order.size(); ++i)
+        position[order[i]] = i;
+
+    std::vector<int> sorted(equations.size());
+    for(int i=0; i<sorted.size(); ++i)
+        sorted[i] = i;
+
+    auto key = [&](int e) {
+        return std::make_pair(std::min(position[equations[e].first], position[equations[e].second]),
+                              std::max(position[equations[e].first], position[equations[e].second]));
+    };
+    std::stable_sort(sorted.begin(), sorted.end(), [&](int a, int b) {return key(a) < key(b);});
+
+    std::vector<int> permutation(equations.size());
+    for(int i=0; i<sorted.size(); ++i)
+        permutation[sorted[i]] = i;
+
+    return permutation;
+};
+
+namespace detail {
+
+//weighted graph used on all levels of the multilevel partitioner
+struct WeightedGraph {
+    std::vector<std::vector<std::pair<int,int>>> adjacency;   //neighbour and edge weight
+    std::vector<int>                             weights;     //vertex weights
+
+    int size() const {
+        return weights.size();
+    };
+
+    int totalWeight() const {
+        int w = 0;
+        for(int v : weights)
+            w += v;
+        return w;
+    };
+};
+
+//heavy edge matching, returns the coarse graph and the coarse vertex of every fine one
+inline WeightedGraph coarsen(const WeightedGraph& graph, std::vector<int>& coarse) {
+
+    const int n = graph.size();
+    std::vector<int> match(n, -1), visit(n);
+    for(int i=0; i<n; ++i)
+        visit[i] = i;
+
+    //low degree vertices first, they have the fewest matching choices
+    std::stable_sort(visit.begin(), visit.end(), [&](int a, int b) {
+        return graph.adjacency[a].size() < graph.adjacency[b].size();
+    });
+
+    coarse.assign(n, -1);
+    int count = 0;
+    for(int v : visit) {
+        if(match[v] != -1)
+            continue;
+
+        int best = v, weight = -1;
+        for(const std::pair<int,int>& e : graph.adjacency[v]) {
+            if(match[e.first] == -1 && e.first != v && e.second > weight) {
+                best   = e.first;
+                weight = e.second;
+            }
+        }
+        match[v] = best;
+        match[best] = v;
+        coarse[v] = coarse[best] = count++;
+    }
+
+    WeightedGraph result;
+    result.adjacency.resize(count);
+    result.weights.assign(count, 0);
+
+    std::vector<int> position(count, -1);
+    for(int v=0; v<n; ++v) {
+
+        const int c = coarse[v];
+        result.weights[c] += graph.weights[v];
+        if(match[v] < v && match[v] != v)
+            continue;   //handled together with its partner
+
+        std::vector<std::pair<int,int>>& edges = result.adjacency[c];
+        for(int u : {v, match[v]}) {
+            for(const std::pair<int,int>& e : graph.adjacency[u]) {
+                const int cn = coarse[e.first];
+                if(cn == c)
+                    continue;
+                if(position[cn] == -1) {
+                    position[cn] = edges.size();
+                    edges.push_back(std::make_pair(cn, 0));
+                }
+                edges[position[cn]].second += e.second;
+            }
+            if(match[v] == v)
+                break;
+        }
+        for(const std::pair<int,int>& e : edges)
+            position[e.first] = -1;
+    }
+    return result;
+};
+
+//grows side 0 from a pseudo peripheral vertex until it holds the target weight
+inline std::vector<int> growBisection(const WeightedGraph& graph, int target) {
+
+    const int n = graph.size();
+    std::vector<int> side(n, 1);
+
+    //pseudo peripheral start vertex: the last one reached by a breadth first search
+    auto furthest = [&](int start) {
+        std::vector<bool> seen(n, false);
+        std::deque<int> queue(1, start);
+        seen[start] = true;
+        int last = start;
+        while(!queue.empty()) {
+            last = queue.front();
+            queue.pop_front();
+            for(const std::pair<int,int>& e : graph.adjacency[last]) {
+                if(!seen[e.first]) {
+                    seen[e.first] = true;
+                    queue.push_back(e.first);
+                }
+            }
+        }
+        return last;
+    };
+
+    int weight = 0, next = 0;
+    std::vector<bool> seen(n, false);
+    std::deque<int> queue;
+    while(weight < target) {
+
+        //disconnected graphs need a new seed
+        if(queue.empty()) {
+            while(next < n && seen[next])
+                ++next;
+            if(next == n)
+                break;
+            const int seed = furthest(next);
+            queue.push_back(seed);
+            seen[seed] = true;
+        }
+
+        const int v = queue.front();
+        queue.pop_front();
+        side[v] = 0;
+        weight += graph.weights[v];
+        for(const std::pair<int,int>& e : graph.adjacency[v]) {
+            if(!seen[e.first]) {
+                seen[e.first] = true;
+                queue.push_back(e.first);
+            }
+        }
+    }
+    return side;
+};
+
+//greedy boundary refinement: moves vertices with positive gain as long as the balance allows it
+inline void refineBisection(const WeightedGraph& graph, std::vector<int>& side, int target, int tolerance) {
+
+    int weight0 = 0;
+    for(int v=0; v<graph.size(); ++v)
+        if(side[v] == 0)
+            weight0 += graph.weights[v];
+
+    for(int pass = 0; pass < 8; ++pass) {
+
+        bool moved = false;
+        for(int v=0; v<graph.size(); ++v) {
+
+            int gain = 0;
+            for(const std::pair<int,int>& e : graph.adjacency[v])
+                gain += (side[e.first] == side[v]) ? -e.second : e.second;
+
+            const int w = (side[v] == 0) ? weight0 - graph.weights[v] : weight0 + graph.weights[v];
+            const bool balanced = std::abs(w - target) <= tolerance;
+            const bool improves = std::abs(w - target) < std::abs(weight0 - target);
+            if((gain > 0 && balanced) || (gain == 0 && improves)) {
+                side[v]  = 1 - side[v];
+                weight0  = w;
+                moved = moved || gain > 0;
+            }
+        }
+        if(!moved)
+            break;
+    }
+};
+
+//multilevel bisection, side 0 gets about the given fraction of the vertex weight
+inline std::vector<int> bisect(const WeightedGraph& graph, double fraction) {
+
+    const int target    = int(fraction*graph.totalWeight() + 0.5);
+    const int tolerance = std::max(1, graph.totalWeight()/50);
+
+    if(graph.size() <= 64) {
+        std::vector<int> side = growBisection(graph, target);
+        refineBisection(graph, side, target, tolerance);
+        return side;
+    }
+
+    std::vector<int> coarse;
+    WeightedGraph coarseGraph = coarsen(graph, coarse);
+
+    //no progress in coarsening anymore, e.g. for star like graphs
+    std::vector<int> side;
+    if(coarseGraph.size() > 0.9*graph.size())
+        side = growBisection(graph, target);
+    else {
+        std::vector<int> coarseSide = bisect(coarseGraph, fraction);
+        side.resize(graph.size());
+        for(int v=0; v<graph.size(); ++v)
+            side[v] = coarseSide[coarse[v]];
+    }
+    refineBisection(graph, side, target, tolerance);
+    return side;
+};
+
+inline void recursivePartition(const WeightedGraph& graph, const std::vector<int>& vertices, int parts,
+                               int first, std::vector<int>& result) {
+
+    if(parts == 1 || vertices.size() <= 1) {
+        for(int v : vertices)
+            result[v] = first;
+        return;
+    }
+
+    //extract the subgraph of the given vertices
+    std::vector<int> local(graph.size(), -1);
+    for(int i=0; i<vertices.size(); ++i)
+        local[vertices[i]] = i;
+
+    WeightedGraph sub;
+    sub.adjacency.resize(vertices.size());
+    sub.weights.resize(vertices.size());
+    for(int i=0; i<vertices.size(); ++i) {
+        sub.weights[i] = graph.weights[vertices[i]];
+        for(const std::pair<int,int>& e : graph.adjacency[vertices[i]])
+            if(local[e.first] != -1)
+                sub.adjacency[i].push_back(std::make_pair(local[e.first], e.second));
+    }
+
+    const int parts0 = parts/2;
+    std::vector<int> side = bisect(sub, double(parts0)/parts);
+
+    std::vector<int> v0, v1;
+    for(int i=0; i<vertices.size(); ++i)
+        (side[i] == 0 ? v0 : v1).push_back(vertices[i]);
+
+    recursivePartition(graph, v0, parts0, first, result);
+    recursivePartition(graph, v1, parts - parts0, first + parts0, result);
+};
+
+} //detail
+
+/**
+ * @brief Balanced partitioning of the constraint graph
+ *
+ * Multilevel recursive bisection: the graph is coarsened by heavy edge matching, the coarsest graph is
+ * bisected by graph growing and the bisection is refined on every level while projecting it back. The
+ * vertex weights are the number of parameters of every block, hence the parts are balanced by their
+ * parameter count and not by their vertex count.
+ *
+ * @param adjacency The neighbours of every vertex, must be symmetric
+ * @param parts The number of parts
+ * @param weights The weight of every vertex, all one if empty
+ * @return std::vector<int> The part of every vertex
+ */
+inline std::vector<int> partition(const std::vector<std::vector<int>>& adjacency, int parts,
+                                  const std::vector<int>& weights = std::vector<int>()) {
+
+    dcm_assert(parts > 0);
+    dcm_assert(weights.empty() || weights.size() == adjacency.size());
+
+    detail::WeightedGraph graph;
+    graph.adjacency.resize(adjacency.size());
+    graph.weights = weights.empty() ? std::vector<int>(adjacency.size(), 1) : weights;
+    for(int v=0; v<adjacency.size(); ++v)
+        for(int n : adjacency[v])
+            graph.adjacency[v].push_back(std::make_pair(n, 1));
+
+    std::vector<int> vertices(adjacency.size()), result(adjacency.size(), 0);
+    for(int i=0; i<vertices.size(); ++i)
+        vertices[i] = i;
+
+    detail::recursivePartition(graph, vertices, parts, 0, result);
+    return result;
+};
+
+/**
+ * @brief Turns an edge partition into a vertex separator
+ *
+ * Vertices are moved into the separator until no edge connects two different parts anymore. Vertices
+ * with many cut edges are taken first, which keeps the separator small. Separator vertices get the
+ * part id -1.
+ *
+ * @param adjacency The neighbours of every vertex, must be symmetric
+ * @param part The part of every vertex, modified in place
+ * @return int The number of separator vertices
+ */
+inline int separate(const std::vector<std::vector<int>>& adjacency, std::vector<int>& part) {
+
+    std::vector<int> cut(adjacency.size(), 0), vertices;
+    for(int v=0; v<adjacency.size(); ++v) {
+        for(int n : adjacency[v])
+            if(part[n] != part[v])
+                ++cut[v];
+        if(cut[v] > 0)
+            vertices.push_back(v);
+    }
+    std::stable_sort(vertices.begin(), vertices.end(), [&](int a, int b) {return cut[a] > cut[b];});
+
+    int count = 0;
+    for(int v : vertices) {
+        const bool needed = std::any_of(adjacency[v].begin(), adjacency[v].end(), [&](int n) {
+            return part[n] != -1 && part[n] != part[v];
+        });
+        if(needed) {
+            part[v] = -1;
+            ++count;
+        }
+    }
+    return count;
+};
+
+} //ordering
+} //numeric
+} //dcm
+
+#endif //DCM_ORDERING_H
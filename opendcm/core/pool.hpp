@@ -0,0 +1,343 @@
+/*
+    openDCM, dimensional constraint manager
+    Copyright (C) 2015  Stefan Troeger <stefantroeger@gmx.net>
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along
+    with this library; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef DCM_POOL_HPP
+#define DCM_POOL_HPP
+
+#include <list>
+#include <mutex>
+#include <vector>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <algorithm>
+#include <functional>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#include <boost/graph/adjacency_list.hpp>
+
+namespace dcm {
+namespace graph {
+
+namespace detail {
+
+/**
+ * @brief Slab storage for nodes of a single size class
+ *
+ * The node based containers of the graphs allocate every vertex, edge and out edge entry on its own.
+ * Doing this with the global heap scatters the nodes of a graph over the whole memory after some
+ * editing. The pool hands out nodes from contiguous slabs instead, so that nodes created after each
+ * other are neighbours in memory. Every thread has its own cache with a free list and the slab it
+ * currently allocates from, so allocation and deallocation are a few pointer operations without any
+ * locking. Only fetching a new slab locks the shared state. Nodes freed in a thread go to the free
+ * list of that thread, and the free list of a finishing thread is handed over to the shared state for
+ * reuse.
+ *
+ * Slabs are never returned to the system, they are reused for the lifetime of the program. The shared
+ * state is therefore intentionally not destructed to allow threads which outlive the static objects
+ * to release their nodes. Nodes released by a thread whose cache is already destructed, e.g. by static
+ * objects destroyed at program exit, go directly to the shared state.
+ *
+ * Reusing freed nodes in LIFO order hands them out in arbitrary address order after a lot of editing.
+ * Therefore the free list is sorted by address once most of it was filled since the last sort, so that
+ * nodes created after each other are again close in memory.
+ *
+ * @tparam NodeSize the size of the nodes handled, must be a multiple of the node alignment
+ */
+template<std::size_t NodeSize>
+class NodePool {
+
+    struct Node {
+        Node* next;
+    };
+
+    static const std::size_t MinSlabNodes = 32;
+    static const std::size_t MaxSlabNodes = 4096;
+    static const std::size_t SortThreshold = 64;
+
+    struct Shared {
+        std::mutex          mutex;
+        Node*               orphans = nullptr;
+        std::vector<void*>  slabs;
+    };
+
+    //the mutex is held over a fork, otherwise a child process could inherit it locked by another thread.
+    //There is no fork on windows, hence nothing to guard there
+    static Shared& shared() {
+        static Shared* s = []() {
+            Shared* shared = new Shared;
+#ifndef _WIN32
+            pthread_atfork([]() {NodePool::shared().mutex.lock();},
+                           []() {NodePool::shared().mutex.unlock();},
+                           []() {NodePool::shared().mutex.unlock();});
+#endif
+            return shared;
+        }();
+        return *s;
+    };
+
+    struct Cache {
+        Node*       free = nullptr;
+        std::size_t freeCount = 0;
+        std::size_t unsorted = 0;     //nodes added to the free list since it was sorted last
+        char*       current = nullptr;
+        char*       end = nullptr;
+        std::size_t slabNodes = MinSlabNodes;
+
+        ~Cache() {
+            destroyed() = true;
+
+            //the not yet used part of the slab is made available too
+            for(; current != end; current += NodeSize)
+                push(reinterpret_cast<Node*>(current));
+            if(!free)
+                return;
+
+            Node* last = free;
+            while(last->next)
+                last = last->next;
+
+            Shared& s = shared();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            last->next = s.orphans;
+            s.orphans = free;
+        };
+
+        void push(Node* n) {
+            n->next = free;
+            free = n;
+            ++freeCount;
+            ++unsorted;
+        };
+
+        Node* pop() {
+            if(unsorted > SortThreshold && 2*unsorted > freeCount)
+                sort();
+
+            Node* n = free;
+            free = n->next;
+            --freeCount;
+            unsorted = std::min(unsorted, freeCount);
+            return n;
+        };
+
+        void sort() {
+            std::vector<Node*> nodes;
+            nodes.reserve(freeCount);
+            for(Node* n = free; n; n = n->next)
+                nodes.push_back(n);
+
+            std::sort(nodes.begin(), nodes.end(), std::less<Node*>());
+            free = nullptr;
+            for(auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
+                (*it)->next = free;
+                free = *it;
+            }
+            unsorted = 0;
+        };
+
+        void refill() {
+            Shared& s = shared();
+            std::lock_guard<std::mutex> lock(s.mutex);
+
+            //prefer the nodes left behind by finished threads
+            if(s.orphans) {
+                for(Node* n = s.orphans; n; n = n->next)
+                    ++freeCount;
+                free = s.orphans;
+                unsorted = freeCount;
+                s.orphans = nullptr;
+                return;
+            }
+
+            current = static_cast<char*>(::operator new(slabNodes*NodeSize));
+            end = current + slabNodes*NodeSize;
+            s.slabs.push_back(current);
+            if(slabNodes < MaxSlabNodes)
+                slabNodes *= 2;
+        };
+    };
+
+    static Cache& cache() {
+        static thread_local Cache c;
+        return c;
+    };
+
+    //trivially destructible, hence still accessible after the thread local cache is gone
+    static bool& destroyed() {
+        static thread_local bool d = false;
+        return d;
+    };
+
+public:
+    static void* allocate() {
+
+        if(destroyed()) {
+            Shared& s = shared();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            if(!s.orphans)
+                return ::operator new(NodeSize);
+
+            Node* n = s.orphans;
+            s.orphans = n->next;
+            return n;
+        }
+
+        Cache& c = cache();
+        if(!c.free && c.current == c.end)
+            c.refill();
+
+        if(c.free)
+            return c.pop();
+
+        void* p = c.current;
+        c.current += NodeSize;
+        return p;
+    };
+
+    static void deallocate(void* p) {
+
+        Node* n = static_cast<Node*>(p);
+        if(destroyed()) {
+            Shared& s = shared();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            n->next = s.orphans;
+            s.orphans = n;
+            return;
+        }
+
+        cache().push(n);
+    };
+
+    /**
+     * @brief Number of slabs fetched for this size class over all threads
+     */
+    static std::size_t slabCount() {
+        Shared& s = shared();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        return s.slabs.size();
+    };
+};
+
+//round up to the strictest fundamental alignment, so that all nodes in a slab are properly aligned
+template<std::size_t Size>
+struct size_class {
+    static const std::size_t align = alignof(std::max_align_t);
+    static const std::size_t value = ((Size < sizeof(void*) ? sizeof(void*) : Size) + align - 1) / align * align;
+};
+
+} //detail
+
+/**
+ * @brief Allocator for node based containers which draws its nodes from a \ref detail::NodePool
+ *
+ * All node types of the same size class share a pool. Only single node allocations are served from
+ * the pool, array allocations are forwarded to the global heap. The allocator is stateless, hence all
+ * instances compare equal and nodes can be freely spliced between containers.
+ */
+template<typename T>
+struct NodeAllocator {
+
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    template<typename U>
+    struct rebind {
+        typedef NodeAllocator<U> other;
+    };
+
+    typedef detail::NodePool<detail::size_class<sizeof(T)>::value> Pool;
+
+    NodeAllocator() {};
+    template<typename U>
+    NodeAllocator(const NodeAllocator<U>&) {};
+
+    T* allocate(std::size_t n) {
+        if(n == 1 && alignof(T) <= alignof(std::max_align_t))
+            return static_cast<T*>(Pool::allocate());
+
+        return static_cast<T*>(::operator new(n*sizeof(T)));
+    };
+
+    void deallocate(T* p, std::size_t n) {
+        if(n == 1 && alignof(T) <= alignof(std::max_align_t))
+            Pool::deallocate(p);
+        else
+            ::operator delete(p);
+    };
+
+    template<typename U, typename... Args>
+    void construct(U* p, Args&&... args) {
+        ::new((void*)p) U(std::forward<Args>(args)...);
+    };
+
+    template<typename U>
+    void destroy(U* p) {
+        p->~U();
+    };
+
+    std::size_t max_size() const {
+        return std::size_t(-1) / sizeof(T);
+    };
+};
+
+template<typename T, typename U>
+bool operator==(const NodeAllocator<T>&, const NodeAllocator<U>&) {
+    return true;
+};
+
+template<typename T, typename U>
+bool operator!=(const NodeAllocator<T>&, const NodeAllocator<U>&) {
+    return false;
+};
+
+/**
+ * @brief Container selector for boost graphs which stores the nodes in a \ref NodeAllocator pool
+ *
+ * Behaves exactly like boost::listS, hence descriptors stay stable on removal, but keeps the graph
+ * nodes close in memory.
+ */
+struct pool_listS {};
+
+} //graph
+} //dcm
+
+namespace boost {
+
+template<typename ValueType>
+struct container_gen<dcm::graph::pool_listS, ValueType> {
+    typedef std::list<ValueType, dcm::graph::NodeAllocator<ValueType> > type;
+};
+
+template<>
+struct parallel_edge_traits<dcm::graph::pool_listS> {
+    typedef allow_parallel_edge_tag type;
+};
+
+} //boost
+
+#endif //DCM_POOL_HPP
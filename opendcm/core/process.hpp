@@ -0,0 +1,205 @@
+/*
+    openDCM, dimensional constraint manager
+    Copyright (C) 2015  Stefan Troeger <stefantroeger@gmx.net>
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along
+    with this library; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef DCM_PROCESS_HPP
+#define DCM_PROCESS_HPP
+
+#include <chrono>
+#include <thread>
+#include <cerrno>
+#include <cstddef>
+#include <new>
+#include <fstream>
+#include <algorithm>
+
+#include <unistd.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#include <boost/exception/errinfo_errno.hpp>
+
+#include "defines.hpp"
+#include "kernel.hpp"
+
+namespace dcm {
+namespace numeric {
+
+/**
+ * @brief Nonlinear solver which runs the solving in a separate process
+ *
+ * A pathological system can crash or hang inside of the solver. To protect the calling process the
+ * solving is done in a forked child process, which inherits the whole system including the recalculate
+ * functor without any serialization. The child writes the resulting parameters into a shared memory
+ * region which the parent maps directly, no data is copied through pipes or files. A crashing or
+ * hanging child therefore only results in a \ref solving_error, the system keeps its parameters from
+ * before the solving run.
+ *
+ * The child can be bounded with operating system limits: \a memoryLimit restricts the additional
+ * address space (in bytes) and \a cpuLimit the cpu time (in seconds) it may use, \a timeout bounds the
+ * wall clock time (in seconds) the parent waits for the result. A zero value disables the limit, the 
+ * timeout is enabled by default so that a stuck child never blocks the caller forever.
+ *
+ * The child process only contains the forking thread and inherits the locks of the parent in whatever
+ * state they had at the fork. It therefore runs strictly single threaded: the linear backend of the
+ * solver is switched to its serial factorization and the recalculate functor must not use the task
+ * scheduler or other threads either. The shared region is kept between solving runs and only grows if
+ * a bigger system is solved.
+ *
+ * @tparam Solver the nonlinear solver used in the child process
+ */
+template<typename Kernel, template<class> class Solver = Dogleg>
+struct ProcessSolver {
+
+    typedef typename Kernel::Scalar                  Scalar;
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, 1> VectorX;
+    typedef Solver<Kernel>                           SolverType;
+
+    SolverType  solver;
+    double      timeout = 30;
+    std::size_t memoryLimit = 0;
+    int         cpuLimit = 0;
+
+    //statistics of the last solving run
+    int iter = 0;
+
+    ProcessSolver() {};
+    ProcessSolver(const ProcessSolver&) = delete;
+
+    ~ProcessSolver() {
+        if(m_region)
+            munmap(m_region, m_capacity);
+    };
+
+    template<typename Functor>
+    SolverResult solve(LinearSystem<Kernel>& sys, Functor& recalculate) {
+
+        const int n = sys.parameter().rows();
+        reserve(n);
+        Header* header = new(m_region) Header;
+
+        const pid_t pid = fork();
+        if(pid < 0)
+            throw solving_error() <<  boost::errinfo_errno(30) << error_message("Solving process could not be created");
+
+        if(pid == 0) {
+            //never return into the code of the parent process, also not by exceptions
+            try {
+                applyLimits();
+                solver.linear.parallel = false;
+                header->result     = solver.solve(sys, recalculate);
+                header->iterations = solver.iter;
+                Eigen::Map<VectorX>(values(), n) = sys.parameter();
+                header->done = true;
+            }
+            catch(...) {};
+            _exit(header->done ? 0 : 1);
+        }
+
+        const int status = wait(pid);
+        if(!WIFEXITED(status) || WEXITSTATUS(status) != 0 || !header->done)
+            throw solving_error() <<  boost::errinfo_errno(31) << error_message("Solving process failed");
+
+        sys.parameter() = Eigen::Map<VectorX>(values(), n);
+        recalculate();
+        iter = header->iterations;
+        return header->result;
+    };
+
+private:
+    struct Header {
+        bool         done = false;
+        SolverResult result = SolverResult::MaxIterations;
+        int          iterations = 0;
+    };
+
+    static const std::size_t Offset = (sizeof(Header) + alignof(std::max_align_t) - 1)
+                                        / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+    Scalar* values() {
+        return reinterpret_cast<Scalar*>(static_cast<char*>(m_region) + Offset);
+    };
+
+    void reserve(int parameters) {
+
+        const std::size_t size = Offset + parameters*sizeof(Scalar);
+        if(m_region && size <= m_capacity)
+            return;
+
+        if(m_region)
+            munmap(m_region, m_capacity);
+
+        m_capacity = std::max(size, std::size_t(sysconf(_SC_PAGESIZE)));
+        m_region = mmap(nullptr, m_capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if(m_region == MAP_FAILED) {
+            m_region = nullptr;
+            throw solving_error() <<  boost::errinfo_errno(30) << error_message("Shared memory for the solving process could not be created");
+        }
+    };
+
+    //called in the child, the address space limit is relative to the memory inherited from the parent
+    void applyLimits() {
+
+        if(memoryLimit) {
+            std::size_t pages = 0;
+            std::ifstream("/proc/self/statm") >> pages;
+            const rlim_t limit = pages*sysconf(_SC_PAGESIZE) + memoryLimit;
+            const rlimit rl = {limit, limit};
+            setrlimit(RLIMIT_AS, &rl);
+        }
+        if(cpuLimit) {
+            const rlimit rl = {rlim_t(cpuLimit), rlim_t(cpuLimit)};
+            setrlimit(RLIMIT_CPU, &rl);
+        }
+    };
+
+    //waits for the child with increasing polling intervals, short solving runs stay interactive
+    int wait(pid_t pid) {
+
+        const auto start = std::chrono::steady_clock::now();
+        std::chrono::microseconds pause(20);
+        int status = 0;
+        while(true) {
+
+            const pid_t r = waitpid(pid, &status, WNOHANG);
+            if(r == pid)
+                return status;
+            if(r < 0 && errno != EINTR)
+                throw solving_error() <<  boost::errinfo_errno(31) << error_message("Solving process failed");
+
+            if(timeout > 0 && std::chrono::steady_clock::now() - start > std::chrono::duration<double>(timeout)) {
+                kill(pid, SIGKILL);
+                waitpid(pid, &status, 0);
+                throw solving_error() <<  boost::errinfo_errno(32) << error_message("Solving process timed out");
+            }
+
+            std::this_thread::sleep_for(pause);
+            pause = std::min(2*pause, std::chrono::microseconds(5000));
+        }
+    };
+
+    void*       m_region = nullptr;
+    std::size_t m_capacity = 0;
+};
+
+}//numeric
+}//dcm
+
+#endif //DCM_PROCESS_HPP
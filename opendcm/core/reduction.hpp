@@ -1050,10 +1050,14 @@ struct ConstraintBuilder : public EdgeBuilder<Kernel> {
     createEquations(CalcPtr g1, CalcPtr g2) override {
         
         std::vector<CalcPtr> equations;
-        for(auto tuple : m_constraints)
-            equations.push_back(m_generatorArry[std::get<1>(tuple)->type]
-                                               [std::get<2>(tuple)->type]
-                                               [std::get<0>(tuple)->type]->buildEquation(g1, g2, std::get<0>(tuple)));
+        for(auto tuple : m_constraints) {
+            CalcPtr eqn = m_generatorArry[std::get<1>(tuple)->type]
+                                         [std::get<2>(tuple)->type]
+                                         [std::get<0>(tuple)->type]->buildEquation(g1, g2, std::get<0>(tuple));
+            //constraints between fixed geometries are folded and have no equation
+            if(eqn)
+                equations.push_back(eqn);
+        }
         
         return equations;
     };
@@ -1069,16 +1073,19 @@ struct ConstraintBuilder : public EdgeBuilder<Kernel> {
                                        [std::get<0>(m_constraints[0])->type]->buildEquationNode(g1, g2, 
                                                                                                 std::get<0>(m_constraints[0]),
                                                                                                 flow);
-            std::vector<CalcPtr> vec(1);
-            vec.push_back(node.first);
+            std::vector<CalcPtr> vec;
+            if(node.first)
+                vec.push_back(node.first);
             return std::make_pair(vec, node.second);
         }
                 
-        //if we have multiple constraints we need to call the virtual functions anyway
+        //multiple constraints are evaluated together to share the values they have in common
         auto equations = createEquations(g1,g2);
+        auto fused = m_generatorArry[std::get<1>(m_constraints[0])->type]
+                                    [std::get<2>(m_constraints[0])->type]
+                                    [std::get<0>(m_constraints[0])->type]->buildFusedEquation(g1, g2, equations);
         return std::make_pair(equations, flow.newActionNode([=](const shedule::FlowGraph::ContinueMessage& m){
-            for(auto cons : equations)
-                cons->execute();
+            fused->execute();
         }));
     };
 
@@ -1088,10 +1095,13 @@ struct ConstraintBuilder : public EdgeBuilder<Kernel> {
         
         std::vector<CalcPtr> equations;
         reduction::ConstraintWalker<Kernel>* walker = (m_targetVertex == target) ? m_targetWalker : m_sourceWalker;
-        for(auto tuple : *walker)
-            equations.push_back(m_generatorArry[std::get<1>(tuple)->type]
-                                               [std::get<2>(tuple)->type]
-                                               [std::get<0>(tuple)->type]->buildEquation(g1, g2, std::get<0>(tuple)));
+        for(auto tuple : *walker) {
+            CalcPtr eqn = m_generatorArry[std::get<1>(tuple)->type]
+                                         [std::get<2>(tuple)->type]
+                                         [std::get<0>(tuple)->type]->buildEquation(g1, g2, std::get<0>(tuple));
+            if(eqn)
+                equations.push_back(eqn);
+        }
         
         return equations;
     };
@@ -1108,16 +1118,19 @@ struct ConstraintBuilder : public EdgeBuilder<Kernel> {
                                        [std::get<0>(walker->front())->type]->buildEquationNode(g1, g2, 
                                                                                                std::get<0>(walker->front()),
                                                                                                flow);
-            std::vector<CalcPtr> vec(1);
-            vec.push_back(node.first);
+            std::vector<CalcPtr> vec;
+            if(node.first)
+                vec.push_back(node.first);
             return std::make_pair(vec, node.second);   
         }
                 
-        //if we have multiple constraints we need to call the virtual functions anyway
+        //multiple constraints are evaluated together to share the values they have in common
         auto equations = createReducedEquations(target,g1,g2);
+        auto fused = m_generatorArry[std::get<1>(walker->front())->type]
+                                    [std::get<2>(walker->front())->type]
+                                    [std::get<0>(walker->front())->type]->buildFusedEquation(g1, g2, equations);
         return std::make_pair(equations, flow.newActionNode([=](const shedule::FlowGraph::ContinueMessage& m){
-            for(auto cons : equations)
-                cons->execute();
+            fused->execute();
         }));
     };
     
@@ -1142,38 +1155,56 @@ namespace symbolic {
  * directly created. Instead the NumericConverter adds an EquationBuilder to the graph which can be 
  * used to create the generalized or cartesian coordinate equations dependend on other analysis results.
  * 
- * @note This class is very heavy to initiate, it should not be created on the stack
+ * The reduction trees and equation generators only depend on the geometry and constraint types, they are
+ * immutable after creation and hence shared by all converters of the same type. They are created on first
+ * use, so that constructing a converter, and with it a System, is cheap.
  */
 #include <boost/type_traits/is_same.hpp>
 template<typename Kernel, typename GeometryList, typename ConstraintList, typename Graph>
 struct NumericConverter {
-              
-    NumericConverter() {     
-        
-        int size = mpl::size<GeometryList>::type::value;
-        m_treeArray.resize(boost::extents[size][size]);
+    
+    typedef boost::multi_array<reduction::EdgeReductionTree*,2>                 TreeArray;
+    typedef boost::multi_array<numeric::ConstraintEquationGenerator<Kernel>*,3> GeneratorArray;
+    
+    /**
+     * @brief The reduction trees and generators for all geometry and constraint combinations
+     */
+    struct Metadata {
         
-        //build up the default reduction nodes
-        //mpl trickery to get a sequence counting from 0 to the size of stroage entries
-        typedef mpl::range_c<int,0,
-                mpl::size<GeometryList>::value> StorageRange;
-        //now iterate that sequence so we can access all storage elements with knowing the position
-        //we are at
-        utilities::RecursiveSequenceApplyer<GeometryList, ReductionTreeCreator> r(m_treeArray);
-        mpl::for_each<StorageRange>(r);
+        TreeArray      treeArray;
+        GeneratorArray generatorArray;
         
-        //do all the same for the constraints
-        int constraints = mpl::size<ConstraintList>::type::value;
-        m_generatorArray.resize(boost::extents[size][size][constraints]);        
-        utilities::RecursiveSequenceApplyer<GeometryList, ConstraintGeneratorCreator<ConstraintList>::template type> g(m_generatorArray);
-        mpl::for_each<StorageRange>(g);
+        Metadata() {
+            
+            int size = mpl::size<GeometryList>::type::value;
+            treeArray.resize(boost::extents[size][size]);
+            
+            //build up the default reduction nodes
+            //mpl trickery to get a sequence counting from 0 to the size of stroage entries
+            typedef mpl::range_c<int,0,
+                    mpl::size<GeometryList>::value> StorageRange;
+            //now iterate that sequence so we can access all storage elements with knowing the position
+            //we are at
+            utilities::RecursiveSequenceApplyer<GeometryList, ReductionTreeCreator> r(treeArray);
+            mpl::for_each<StorageRange>(r);
+            
+            //do all the same for the constraints
+            int constraints = mpl::size<ConstraintList>::type::value;
+            generatorArray.resize(boost::extents[size][size][constraints]);        
+            utilities::RecursiveSequenceApplyer<GeometryList, ConstraintGeneratorCreator<ConstraintList>::template type> g(generatorArray);
+            mpl::for_each<StorageRange>(g);
+        };
     };
     
-    ~NumericConverter() {
-        //delete all reduction nodes
-        int size = std::pow(mpl::size<GeometryList>::value, 2);
-        //for(int i=0; i<size; ++i) 
-        //    delete m_treeArray(i);
+    /**
+     * @brief The metadata shared by all converters of this type, created on first access
+     * 
+     * The metadata is intentionally never destructed, as equation builders created from it may outlive
+     * the static objects.
+     */
+    static const Metadata& metadata() {
+        static const Metadata* m = new Metadata;
+        return *m;
     };
     
     /**
@@ -1187,8 +1218,9 @@ struct NumericConverter {
         symbolic::Geometry* target = g->template getProperty<symbolic::GeometryProperty>(g->target(edge));
         
         //get the two reduction trees for this geometry combination
-        reduction::EdgeReductionTree* stTree = m_treeArray[source->type][target->type];
-        reduction::EdgeReductionTree* tsTree = m_treeArray[target->type][source->type];
+        const Metadata& data = metadata();
+        reduction::EdgeReductionTree* stTree = data.treeArray[source->type][target->type];
+        reduction::EdgeReductionTree* tsTree = data.treeArray[target->type][source->type];
      
         //get all constraints and cluster geometries, is needed
         typedef typename Graph::global_edge_iterator iterator;
@@ -1214,14 +1246,11 @@ struct NumericConverter {
             delete reduction;
         
         reduction = new numeric::ConstraintBuilder<Kernel>(g->source(edge), g->target(edge), 
-                                                           tsWalker, stWalker, symbolics, m_generatorArray);
+                                                           tsWalker, stWalker, symbolics, data.generatorArray);
         g->template setProperty<numeric::EquationBuilderProperty<Kernel>>(edge, reduction);
     };
     
 private:
-    boost::multi_array<reduction::EdgeReductionTree*,2>                 m_treeArray;
-    boost::multi_array<numeric::ConstraintEquationGenerator<Kernel>*,3> m_generatorArray;
-       
     template<typename Sequence>
     struct ReductionTreeCreator {
     
@@ -27,9 +27,17 @@
 
 #include "defines.hpp"
 
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <memory>
+
 #include <tbb/parallel_for.h>
 #include <tbb/parallel_for_each.h>
 #include <tbb/flow_graph.h>
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/task_arena.h>
 
 
 namespace dcm {
@@ -129,8 +137,15 @@ struct ParallelVector : public SequentialVector {
  */
 struct HugeParallelVector : public SequentialVector {
     
+    /**
+     * @param grainsize Minimal number of consecutive executables processed by one thread. Neighbouring 
+     *                  executables are kept together, hence adding them in memory order gives cache 
+     *                  friendly chunks
+     */
+    HugeParallelVector(int grainsize = 1) : m_grainsize(grainsize) {};
+    
     void operator()() {
-         tbb::parallel_for( tbb::blocked_range<int>( 1, m_executables.size()), 
+         tbb::parallel_for( tbb::blocked_range<int>( 0, m_executables.size(), m_grainsize), 
                             [&](const tbb::blocked_range<int>& range) {
              for(int i=range.begin(); i!=range.end(); ++i)
                  m_executables[i]->execute();
@@ -140,6 +155,60 @@ struct HugeParallelVector : public SequentialVector {
     virtual void execute() {
         operator()();
     };
+    
+protected:
+    int m_grainsize;
+};
+
+/**
+ * @brief Parallel execution of dependency levels
+ * 
+ * The executables are sorted into levels. All executables of one level are processed in parallel, the 
+ * levels themself sequentially in the order of their number. Hence every executable can rely on all 
+ * executables in lower levels to be finished. This is the structure needed for equation system assembly:
+ * geometries (and clusters they depend on) are calculated first, afterwards all constraints can be
+ * evaluated concurrently. As every constraint writes only its own residual and jacobi row no locking 
+ * is needed. Note that passed executable pointers are afterwards owned by the LevelVector object.
+ */
+struct LevelVector : public Executable {
+    
+    LevelVector(int grainsize = 64) : m_grainsize(grainsize) {};
+    
+    virtual ~LevelVector() {
+        for(HugeParallelVector* level : m_levels) 
+            delete level;
+    };
+    
+    void operator()() {
+        for(HugeParallelVector* level : m_levels) 
+            level->execute();
+    };
+    
+    virtual void execute() {
+        operator()();
+    };
+    
+    template<typename T> 
+    void add(int level, const T& t) {
+        getLevel(level)->add(t);
+    };
+    
+    void addExecutable(int level, Executable* ex) {
+        getLevel(level)->addExecutable(ex);
+    };
+    
+    int levels() { return m_levels.size();};
+    
+protected:
+    HugeParallelVector* getLevel(int level) {
+        while(m_levels.size() <= level)
+            m_levels.push_back(new HugeParallelVector(m_grainsize));
+        
+        return m_levels[level];
+    };
+    
+    int                              m_grainsize;
+    std::vector<HugeParallelVector*> m_levels;
 };
 
 //encapsulates a tbb flow graph and is responsible for managing the nodes lifetime
@@ -198,6 +267,128 @@ void for_each(const Iterator& start, const Iterator& end, const Functor& func) {
     tbb::parallel_for_each(start, end, func);
 };
 
+namespace detail {
+    
+//Executes the forest without recursion, so that the depth of a tree is not limited by the stack. Tasks
+//are only started for the largest subtrees not exceeding the grainsize. All nodes above are processed 
+//by the task finishing their last child, hence a chain of single childs is a single sequential task. 
+template<typename Functor>
+struct TreeExecutor {
+    
+    const std::vector<std::vector<int>>& m_children;
+    const Functor&                       m_func;
+    std::vector<int>                     m_parent, m_size, m_tasks;
+    std::unique_ptr<std::atomic<int>[]>  m_pending;     //unprocessed childs of nodes above the tasks
+    int                                  m_grainsize;
+    
+    TreeExecutor(const std::vector<std::vector<int>>& children, const Functor& func, int grainsize) 
+        : m_children(children), m_func(func), m_parent(children.size(), -1), m_size(children.size(), 0),
+          m_pending(new std::atomic<int>[children.size()]), m_grainsize(std::max(grainsize, 1)) {};
+    
+    void analyze(const std::vector<int>& roots) {
+        
+        //parents are always visited before their childs, hence the sizes accumulate in reverse order
+        std::vector<int> order(roots);
+        for(std::size_t i=0; i<order.size(); ++i) {
+            for(int child : m_children[order[i]]) {
+                m_parent[child] = order[i];
+                order.push_back(child);
+            }
+        }
+        for(auto it = order.rbegin(); it != order.rend(); ++it) {
+            m_size[*it] += 1;
+            if(m_parent[*it] >= 0)
+                m_size[m_parent[*it]] += m_size[*it];
+        }
+        for(int node : order) {
+            m_pending[node] = m_children[node].size();
+            const int parent = m_parent[node];
+            if(m_size[node] <= m_grainsize && (parent < 0 || m_size[parent] > m_grainsize))
+                m_tasks.push_back(node);
+        }
+    };
+    
+    void sequential(int node) {
+        
+        //the stack holds the nodes with the index of the next child to process
+        std::vector<std::pair<int, std::size_t>> stack(1, std::make_pair(node, std::size_t(0)));
+        while(!stack.empty()) {
+            const int current = stack.back().first;
+            if(stack.back().second < m_children[current].size()) 
+                stack.emplace_back(m_children[current][stack.back().second++], 0);
+            else {
+                m_func(current);
+                stack.pop_back();
+            }
+        }
+    };
+    
+    void task(int node) {
+        
+        sequential(node);
+        for(int parent = m_parent[node]; parent >= 0 && --m_pending[parent] == 0; parent = m_parent[parent])
+            m_func(parent);
+    };
+};
+}
+
+/**
+ * @brief Executes a functor for all nodes of a forest in post order
+ * 
+ * The forest is given by the children of every node, a node is only processed after all of its children.
+ * Independent subtrees are processed concurrently, subtrees with at most \a grainsize nodes are processed
+ * sequentially by a single task. This is the dependency structure of a sparse factorization along its 
+ * elimination tree.
+ * 
+ * @param children The children of every node
+ * @param roots The nodes without parent
+ * @param func Functor called with the node index
+ * @param grainsize Maximal subtree size which is not split into tasks anymore
+ */
+template<typename Functor>
+void for_each_postorder(const std::vector<std::vector<int>>& children, const std::vector<int>& roots, 
+                        const Functor& func, int grainsize = 16) {
+    
+    detail::TreeExecutor<Functor> executor(children, func, grainsize);
+    executor.analyze(roots);
+    tbb::parallel_for_each(executor.m_tasks.begin(), executor.m_tasks.end(), [&](int node) {executor.task(node);});
+};
+
+/**
+ * @brief Storage for one state object per worker thread
+ * 
+ * The states are created lazily as copies of the exemplar the first time a worker uses them and stay 
+ * alive until the storage is destroyed or cleared, hence they can be reused over many parallel loops.
+ */
+template<typename State>
+using WorkerStates = tbb::enumerable_thread_specific<State>;
+
+/**
+ * @brief Executes a functor for all indices in [0, count) with a reusable state per worker
+ * 
+ * The functor is called with the index and the state of the executing worker. A state is never used by
+ * two tasks at the same time, therefore it can hold buffers which are reused for all indices processed
+ * by the same worker. This holds also if the functor uses parallel algorithms itself: every call is 
+ * isolated, a worker waiting for its nested tasks does not pick up other indices of this loop which
+ * would need the very same state.
+ * 
+ * @param count Number of indices to process
+ * @param states The per worker states
+ * @param func Functor called with the index and the worker state
+ * @param grainsize Number of indices which are processed sequentially by a single task
+ */
+template<typename State, typename Functor>
+void for_each_with_state(int count, WorkerStates<State>& states, const Functor& func, int grainsize = 1) {
+    
+    tbb::parallel_for(tbb::blocked_range<int>(0, count, grainsize), [&](const tbb::blocked_range<int>& r) {
+        tbb::this_task_arena::isolate([&]() {
+            State& state = states.local();
+            for(int i = r.begin(); i != r.end(); ++i)
+                func(i, state);
+        });
+    });
+};
+
 } //details
 } //dcm
 
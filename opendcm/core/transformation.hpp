@@ -22,14 +22,26 @@
 #define DCM_TRANSFORMATION_H
 
 #include <cmath>
+#include <vector>
 #include <Eigen/Core>
 #include <Eigen/Geometry>
+#include <Eigen/StdVector>
 
 #include <boost/mpl/if.hpp>
 
 namespace dcm {
 namespace details {
 
+//quaternions need to be normalized to represent a rotation, 2D rotations are stored as angle and 
+//are therefore always valid
+template<typename Scalar>
+inline void normalizeRotation(Eigen::Quaternion<Scalar>& q) {
+    q.normalize();
+};
+
+template<typename Scalar>
+inline void normalizeRotation(Eigen::Rotation2D<Scalar>& r) {};
+
 template<typename Scalar, int Dim>
 class Transform {
 
@@ -114,6 +126,15 @@ public:
     template<typename Derived>
     void operator()(Eigen::MatrixBase<Derived>& vec) const;
 
+    //transform multiple vectors at once. They are given as Dim x N matrix with one vector per 
+    //column. The rotation matrix is calculated once for the whole batch, so the transformation is a
+    //single matrix product which is vectorized by Eigen instead of N quaternion applications
+    //*****************
+    template<typename Derived>
+    Derived& transformPoints(Eigen::MatrixBase<Derived>& points) const;
+    template<typename Derived>
+    Derived& rotateDirections(Eigen::MatrixBase<Derived>& directions) const;
+
     //Stuff
     //*****
     bool isApprox(const Transform& other, Scalar prec) const;
@@ -133,6 +154,23 @@ public:
 template<typename charT, typename traits, typename Kernel, int Dim>
 std::basic_ostream<charT,traits>& operator<<(std::basic_ostream<charT,traits>& os, const dcm::details::Transform<Kernel, Dim>& t);
 
+template<typename Scalar, int Dim>
+using TransformVector = std::vector<Transform<Scalar, Dim>, Eigen::aligned_allocator<Transform<Scalar, Dim>>>;
+
+//process multiple transforms at once. The single transform operation is applied elementwise, the 
+//batch only saves the per call overhead
+//********************
+template<typename Scalar, int Dim>
+void invert(TransformVector<Scalar, Dim>& transforms);
+
+//lhs[i] *= rhs[i] for all i, both vectors need to have the same size
+template<typename Scalar, int Dim>
+void compose(TransformVector<Scalar, Dim>& lhs, const TransformVector<Scalar, Dim>& rhs);
+
+//transforms[i] = t * transforms[i] for all i
+template<typename Scalar, int Dim>
+void compose(const Transform<Scalar, Dim>& t, TransformVector<Scalar, Dim>& transforms);
+
 /**********************************************************************************************************************************
  *
  *                      IMPELEMNTATION
@@ -149,7 +187,7 @@ template<typename Scalar, int Dim>
 Transform<Scalar, Dim>::Transform(const Rotation& r) : m_rotation(r),
     m_translation(Translation::Identity()),
     m_scale(Scaling(1.)) {
-    m_rotation.normalize();
+    normalizeRotation(m_rotation);
 };
 
 template<typename Scalar, int Dim>
@@ -166,14 +204,14 @@ template<typename Scalar, int Dim>
 Transform<Scalar, Dim>::Transform(const Rotation& r, const Translation& t) : m_rotation(r),
     m_translation(t),
     m_scale(Scaling(1.)) {
-    m_rotation.normalize();
+    normalizeRotation(m_rotation);
 };
 
 template<typename Scalar, int Dim>
 Transform<Scalar, Dim>::Transform(const Rotation& r, const Translation& t, const Scaling& s) : m_rotation(r),
     m_translation(t),
     m_scale(s) {
-    m_rotation.normalize();
+    normalizeRotation(m_rotation);
 };
 
 template<typename Scalar, int Dim>
@@ -184,14 +222,17 @@ const typename Transform<Scalar, Dim>::Rotation& Transform<Scalar, Dim>::rotatio
 template<typename Scalar, int Dim>
 template<typename Derived>
 Transform<Scalar, Dim>& Transform<Scalar, Dim>::setRotation(const Eigen::RotationBase<Derived,Dim>& rotation) {
-    m_rotation = rotation.derived().normalized();
+    m_rotation = Rotation(rotation.derived());
+    normalizeRotation(m_rotation);
     return *this;
 }
 
 template<typename Scalar, int Dim>
 template<typename Derived>
 Transform<Scalar, Dim>& Transform<Scalar, Dim>::rotate(const Eigen::RotationBase<Derived,Dim>& rotation) {
-    m_rotation = rotation.derived().normalized()*m_rotation;
+    Rotation r(rotation.derived());
+    normalizeRotation(r);
+    m_rotation = r*m_rotation;
     return *this;
 }
 
@@ -286,7 +327,7 @@ template<typename Scalar, int Dim>
 template<typename Derived>
 inline Transform<Scalar, Dim>& Transform<Scalar, Dim>::operator=(const Eigen::RotationBase<Derived,Dim>& r) {
     m_rotation = r.derived();
-    m_rotation.normalize();
+    normalizeRotation(m_rotation);
     m_translation = Translation::Identity();
     m_scale = Scaling(1);
     return *this;
@@ -359,6 +400,22 @@ inline void Transform<Scalar, Dim>::operator()(Eigen::MatrixBase<Derived>& vec)
     transform(vec);
 }
 
+template<typename Scalar, int Dim>
+template<typename Derived>
+inline Derived& Transform<Scalar, Dim>::transformPoints(Eigen::MatrixBase<Derived>& points) const {
+    const RotationMatrix rot = m_rotation.toRotationMatrix()*m_scale.factor();
+    points = (rot*points).colwise() + m_translation.vector()*m_scale.factor();
+    return points.derived();
+}
+
+template<typename Scalar, int Dim>
+template<typename Derived>
+inline Derived& Transform<Scalar, Dim>::rotateDirections(Eigen::MatrixBase<Derived>& directions) const {
+    const RotationMatrix rot = m_rotation.toRotationMatrix();
+    directions = rot*directions;
+    return directions.derived();
+}
+
 template<typename Scalar, int Dim>
 bool Transform<Scalar, Dim>::isApprox(const Transform& other, Scalar prec) const {
     return m_rotation.isApprox(other.rotation(), prec)
@@ -380,7 +437,7 @@ const Transform<Scalar, Dim> Transform<Scalar, Dim>::Identity() {
 
 template<typename Scalar, int Dim>
 Transform<Scalar, Dim>& Transform<Scalar, Dim>::normalize() {
-    m_rotation.normalize();
+    normalizeRotation(m_rotation);
     return *this;
 }
 
@@ -402,6 +459,27 @@ std::basic_ostream<charT,traits>& operator<<(std::basic_ostream<charT,traits>& o
     return os;
 }
 
+template<typename Scalar, int Dim>
+void invert(TransformVector<Scalar, Dim>& transforms) {
+    for(Transform<Scalar, Dim>& t : transforms)
+        t.invert();
+}
+
+template<typename Scalar, int Dim>
+void compose(TransformVector<Scalar, Dim>& lhs, const TransformVector<Scalar, Dim>& rhs) {
+    
+    eigen_assert(lhs.size() == rhs.size());
+    for(std::size_t i=0; i<lhs.size(); ++i)
+        lhs[i] *= rhs[i];
+}
+
+template<typename Scalar, int Dim>
+void compose(const Transform<Scalar, Dim>& t, TransformVector<Scalar, Dim>& transforms) {
+    
+    for(Transform<Scalar, Dim>& other : transforms) 
+        other = t*other;
+}
+
 }//details
 }//DCM
 
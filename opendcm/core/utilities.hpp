@@ -49,6 +49,11 @@ struct Variant {
         return m_variant.which()!=0;
     };
     
+    //index of the stored type within the variants template arguments, -1 if nothing is stored
+    int typeIndex() {
+        return m_variant.which()-1;
+    };
+    
 protected:
     VariantType m_variant;
 };
@@ -0,0 +1,88 @@
+/*
+    openDCM, dimensional constraint manager
+    Copyright (C) 2015  Stefan Troeger <stefantroeger@gmx.net>
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along
+    with this library; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef DCM_ANGLE_2D_H
+#define DCM_ANGLE_2D_H
+
+#include <opendcm/core/constraint.hpp>
+#include "geometry.hpp"
+
+namespace dcm {
+namespace numeric {
+
+//the angle between two lines is expressed via its cosine, this is the same formulation as the one used
+//for 3d directions
+template<typename Kernel>
+struct Constraint<Kernel, dcm::Angle, geometry::Line2<Kernel>, geometry::Line2<Kernel>> 
+    : public ConstraintBase<Kernel, dcm::Angle, geometry::Line2<Kernel>, geometry::Line2<Kernel>> {
+  
+    typedef ConstraintBase<Kernel, dcm::Angle, geometry::Line2<Kernel>, geometry::Line2<Kernel>> Inherited;
+    typedef typename Kernel::Scalar                 Scalar;
+    typedef typename Inherited::Vector              Vector;
+    typedef typename Inherited::Geometry1           Geometry1;
+    typedef typename Inherited::Derivative1         Derivative1;
+    typedef typename Inherited::Geometry2           Geometry2;
+    typedef typename Inherited::Derivative2         Derivative2;
+    
+    Constraint() {};
+    
+    Scalar calculateError(Geometry1& g1, Geometry2& g2) {
+        const auto& t = Inherited::terms(g1, g2);
+        return t.dot / (t.norm1*t.norm2) - std::cos(Inherited::angle());
+    };
+
+    Scalar calculateGradientFirst(Geometry1& g1, Geometry2& g2, Derivative1& dg1) {
+        const auto& t = Inherited::terms(g1, g2);
+        return gradient(g1.direction(), g2.direction(), t.norm1, t.norm2, t.dot).dot(dg1.direction());
+    };
+
+    Scalar calculateGradientSecond(Geometry1& g1, Geometry2& g2, Derivative2& dg2) {
+        const auto& t = Inherited::terms(g1, g2);
+        return gradient(g2.direction(), g1.direction(), t.norm2, t.norm1, t.dot).dot(dg2.direction());
+    };
+
+    Vector calculateGradientFirstComplete(Geometry1& g1, Geometry2& g2) {
+        const auto& t = Inherited::terms(g1, g2);
+        Vector grad(4);
+        grad.template head<2>().setZero();
+        grad.template tail<2>() = gradient(g1.direction(), g2.direction(), t.norm1, t.norm2, t.dot);
+        return grad;
+    };
+
+    Vector calculateGradientSecondComplete(Geometry1& g1, Geometry2& g2) {
+        const auto& t = Inherited::terms(g1, g2);
+        Vector grad(4);
+        grad.template head<2>().setZero();
+        grad.template tail<2>() = gradient(g2.direction(), g1.direction(), t.norm2, t.norm1, t.dot);
+        return grad;
+    };
+    
+private:
+    //derivative of the cosine with respect to d1
+    template<typename T1, typename T2>
+    Eigen::Matrix<Scalar, 2, 1> gradient(const Eigen::MatrixBase<T1>& d1, const Eigen::MatrixBase<T2>& d2,
+                                         Scalar n1, Scalar n2, Scalar dot) {
+        return d2/(n1*n2) - dot*d1/(std::pow(n1,3)*n2);
+    };
+};
+
+}//numeric
+}//dcm
+
+#endif //DCM_ANGLE_2D_H
@@ -0,0 +1,289 @@
+/*
+    openDCM, dimensional constraint manager
+    Copyright (C) 2015  Stefan Troeger <stefantroeger@gmx.net>
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along
+    with this library; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef DCM_DISTANCE_2D_H
+#define DCM_DISTANCE_2D_H
+
+#include <opendcm/core/constraint.hpp>
+#include "geometry.hpp"
+
+namespace dcm {
+namespace numeric {
+
+template<typename Kernel>
+struct Constraint<Kernel, dcm::Distance, geometry::Point2<Kernel>, geometry::Point2<Kernel>> 
+    : public ConstraintBase<Kernel, dcm::Distance, geometry::Point2<Kernel>, geometry::Point2<Kernel>> {
+  
+    typedef ConstraintBase<Kernel, dcm::Distance, geometry::Point2<Kernel>, geometry::Point2<Kernel>> Inherited;
+    typedef typename Kernel::Scalar                 Scalar;
+    typedef typename Inherited::Vector              Vector;
+    typedef typename Inherited::Geometry1           Geometry1;
+    typedef typename Inherited::Derivative1         Derivative1;
+    typedef typename Inherited::Geometry2           Geometry2;
+    typedef typename Inherited::Derivative2         Derivative2;
+    
+    Constraint() {};
+    
+    Scalar calculateError(Geometry1& g1, Geometry2& g2) {        
+        return (g1.point()-g2.point()).norm() - Inherited::distance();
+    };
+
+    Scalar calculateGradientFirst(Geometry1& g1, Geometry2& g2, Derivative1& dg1) {        
+        return (g1.point()-g2.point()).dot(dg1.point()) / (g1.point()-g2.point()).norm();
+    };
+
+    Scalar calculateGradientSecond(Geometry1& g1, Geometry2& g2, Derivative2& dg2) {        
+        return (g1.point()-g2.point()).dot(-dg2.point()) / (g1.point()-g2.point()).norm();
+    };
+
+    Vector calculateGradientFirstComplete(Geometry1& g1, Geometry2& g2) {
+        return (g1.point()-g2.point()) / (g1.point()-g2.point()).norm();
+    };
+
+    Vector calculateGradientSecondComplete(Geometry1& g1, Geometry2& g2) {
+        return (g2.point()-g1.point()) / (g1.point()-g2.point()).norm();
+    };
+};
+
+//the distance between point and line is the signed area of the parallelogram spanned by the line 
+//direction and the point offset, normed by the direction length. We use the absolute value as the 
+//side of the line is not of interest for a bidirectional distance.
+template<typename Kernel>
+struct Constraint<Kernel, dcm::Distance, geometry::Point2<Kernel>, geometry::Line2<Kernel>> 
+    : public ConstraintBase<Kernel, dcm::Distance, geometry::Point2<Kernel>, geometry::Line2<Kernel>> {
+  
+    typedef ConstraintBase<Kernel, dcm::Distance, geometry::Point2<Kernel>, geometry::Line2<Kernel>> Inherited;
+    typedef typename Kernel::Scalar                 Scalar;
+    typedef typename Inherited::Vector              Vector;
+    typedef typename Inherited::Geometry1           Geometry1;
+    typedef typename Inherited::Derivative1         Derivative1;
+    typedef typename Inherited::Geometry2           Geometry2;
+    typedef typename Inherited::Derivative2         Derivative2;
+    typedef Eigen::Matrix<Scalar, 2, 1>             Vector2;
+    
+    Constraint() {};
+    
+    //a fixed line, e.g. a reference axis, gets its unit normal calculated once
+    void prepareFixedSecond(Geometry2& g2) {
+        m_normal = detail2d::perp(g2.direction())/g2.direction().norm();
+        m_fixedLine = true;
+    };
+    
+    Scalar calculateError(Geometry1& g1, Geometry2& g2) {
+        if(m_fixedLine)
+            return std::abs(m_normal.dot(g1.point() - g2.point())) - Inherited::distance();
+        
+        const Vector2 diff = g1.point() - g2.point();
+        return sign(diff, g2)*detail2d::cross(diff, g2.direction())/g2.direction().norm() - Inherited::distance();
+    };
+
+    Scalar calculateGradientFirst(Geometry1& g1, Geometry2& g2, Derivative1& dg1) {
+        if(m_fixedLine)
+            return fixedSign(g1, g2)*m_normal.dot(dg1.point());
+        
+        const Vector2 diff = g1.point() - g2.point();
+        return sign(diff, g2)*detail2d::perp(g2.direction()).dot(dg1.point())/g2.direction().norm();
+    };
+
+    Scalar calculateGradientSecond(Geometry1& g1, Geometry2& g2, Derivative2& dg2) {
+        const Vector2 diff = g1.point() - g2.point();
+        const Scalar  n    = g2.direction().norm();
+        const Scalar  c    = detail2d::cross(diff, g2.direction());
+        return sign(diff, g2)*(-detail2d::perp(g2.direction()).dot(dg2.point())/n
+                               -detail2d::perp(diff).dot(dg2.direction())/n
+                               -c*g2.direction().dot(dg2.direction())/std::pow(n,3));
+    };
+
+    Vector calculateGradientFirstComplete(Geometry1& g1, Geometry2& g2) {
+        if(m_fixedLine)
+            return fixedSign(g1, g2)*m_normal;
+        
+        const Vector2 diff = g1.point() - g2.point();
+        return sign(diff, g2)*detail2d::perp(g2.direction())/g2.direction().norm();
+    };
+
+    Vector calculateGradientSecondComplete(Geometry1& g1, Geometry2& g2) {
+        const Vector2 diff = g1.point() - g2.point();
+        const Scalar  n    = g2.direction().norm();
+        const Scalar  c    = detail2d::cross(diff, g2.direction());
+        Vector grad(4);
+        grad.template head<2>() = -sign(diff, g2)*detail2d::perp(g2.direction())/n;
+        grad.template tail<2>() = -sign(diff, g2)*(detail2d::perp(diff)/n + c*g2.direction()/std::pow(n,3));
+        return grad;
+    };
+    
+private:
+    Scalar sign(const Vector2& diff, Geometry2& g2) {
+        return (detail2d::cross(diff, g2.direction()) < 0) ? -1 : 1;
+    };
+    
+    Scalar fixedSign(Geometry1& g1, Geometry2& g2) {
+        return (m_normal.dot(g1.point() - g2.point()) < 0) ? -1 : 1;
+    };
+    
+    Eigen::Matrix<Scalar, 2, 1, Eigen::DontAlign> m_normal;
+    bool m_fixedLine = false;
+};
+
+//distance from the circle boundary, e.g. zero means the point lies on the circle
+template<typename Kernel>
+struct Constraint<Kernel, dcm::Distance, geometry::Point2<Kernel>, geometry::Circle2<Kernel>> 
+    : public ConstraintBase<Kernel, dcm::Distance, geometry::Point2<Kernel>, geometry::Circle2<Kernel>> {
+  
+    typedef ConstraintBase<Kernel, dcm::Distance, geometry::Point2<Kernel>, geometry::Circle2<Kernel>> Inherited;
+    typedef typename Kernel::Scalar                 Scalar;
+    typedef typename Inherited::Vector              Vector;
+    typedef typename Inherited::Geometry1           Geometry1;
+    typedef typename Inherited::Derivative1         Derivative1;
+    typedef typename Inherited::Geometry2           Geometry2;
+    typedef typename Inherited::Derivative2         Derivative2;
+    
+    Constraint() {};
+    
+    Scalar calculateError(Geometry1& g1, Geometry2& g2) {        
+        return (g1.point()-g2.center()).norm() - g2.radius() - Inherited::distance();
+    };
+
+    Scalar calculateGradientFirst(Geometry1& g1, Geometry2& g2, Derivative1& dg1) {        
+        return (g1.point()-g2.center()).dot(dg1.point()) / (g1.point()-g2.center()).norm();
+    };
+
+    Scalar calculateGradientSecond(Geometry1& g1, Geometry2& g2, Derivative2& dg2) {        
+        return (g1.point()-g2.center()).dot(-dg2.center()) / (g1.point()-g2.center()).norm() - dg2.radius();
+    };
+
+    Vector calculateGradientFirstComplete(Geometry1& g1, Geometry2& g2) {
+        return (g1.point()-g2.center()) / (g1.point()-g2.center()).norm();
+    };
+
+    Vector calculateGradientSecondComplete(Geometry1& g1, Geometry2& g2) {
+        Vector grad(3);
+        grad.template head<2>() = (g2.center()-g1.point()) / (g1.point()-g2.center()).norm();
+        grad(2) = -1;
+        return grad;
+    };
+};
+
+//distance between line and circle boundary, e.g. zero means the line is tangent to the circle
+template<typename Kernel>
+struct Constraint<Kernel, dcm::Distance, geometry::Line2<Kernel>, geometry::Circle2<Kernel>> 
+    : public ConstraintBase<Kernel, dcm::Distance, geometry::Line2<Kernel>, geometry::Circle2<Kernel>> {
+  
+    typedef ConstraintBase<Kernel, dcm::Distance, geometry::Line2<Kernel>, geometry::Circle2<Kernel>> Inherited;
+    typedef typename Kernel::Scalar                 Scalar;
+    typedef typename Inherited::Vector              Vector;
+    typedef typename Inherited::Geometry1           Geometry1;
+    typedef typename Inherited::Derivative1         Derivative1;
+    typedef typename Inherited::Geometry2           Geometry2;
+    typedef typename Inherited::Derivative2         Derivative2;
+    typedef Eigen::Matrix<Scalar, 2, 1>             Vector2;
+    
+    Constraint() {};
+    
+    Scalar calculateError(Geometry1& g1, Geometry2& g2) {
+        const Vector2 diff = g2.center() - g1.point();
+        return sign(diff, g1)*detail2d::cross(diff, g1.direction())/g1.direction().norm() 
+                - g2.radius() - Inherited::distance();
+    };
+
+    Scalar calculateGradientFirst(Geometry1& g1, Geometry2& g2, Derivative1& dg1) {
+        const Vector2 diff = g2.center() - g1.point();
+        const Scalar  n    = g1.direction().norm();
+        const Scalar  c    = detail2d::cross(diff, g1.direction());
+        return sign(diff, g1)*(-detail2d::perp(g1.direction()).dot(dg1.point())/n
+                               -detail2d::perp(diff).dot(dg1.direction())/n
+                               -c*g1.direction().dot(dg1.direction())/std::pow(n,3));
+    };
+
+    Scalar calculateGradientSecond(Geometry1& g1, Geometry2& g2, Derivative2& dg2) {
+        const Vector2 diff = g2.center() - g1.point();
+        return sign(diff, g1)*detail2d::perp(g1.direction()).dot(dg2.center())/g1.direction().norm() 
+                - dg2.radius();
+    };
+
+    Vector calculateGradientFirstComplete(Geometry1& g1, Geometry2& g2) {
+        const Vector2 diff = g2.center() - g1.point();
+        const Scalar  n    = g1.direction().norm();
+        const Scalar  c    = detail2d::cross(diff, g1.direction());
+        Vector grad(4);
+        grad.template head<2>() = -sign(diff, g1)*detail2d::perp(g1.direction())/n;
+        grad.template tail<2>() = -sign(diff, g1)*(detail2d::perp(diff)/n + c*g1.direction()/std::pow(n,3));
+        return grad;
+    };
+
+    Vector calculateGradientSecondComplete(Geometry1& g1, Geometry2& g2) {
+        const Vector2 diff = g2.center() - g1.point();
+        Vector grad(3);
+        grad.template head<2>() = sign(diff, g1)*detail2d::perp(g1.direction())/g1.direction().norm();
+        grad(2) = -1;
+        return grad;
+    };
+    
+private:
+    Scalar sign(const Vector2& diff, Geometry1& g1) {
+        return (detail2d::cross(diff, g1.direction()) < 0) ? -1 : 1;
+    };
+};
+
+//distance between the circle boundaries, e.g. zero means the circles touch from outside
+template<typename Kernel>
+struct Constraint<Kernel, dcm::Distance, geometry::Circle2<Kernel>, geometry::Circle2<Kernel>> 
+    : public ConstraintBase<Kernel, dcm::Distance, geometry::Circle2<Kernel>, geometry::Circle2<Kernel>> {
+  
+    typedef ConstraintBase<Kernel, dcm::Distance, geometry::Circle2<Kernel>, geometry::Circle2<Kernel>> Inherited;
+    typedef typename Kernel::Scalar                 Scalar;
+    typedef typename Inherited::Vector              Vector;
+    typedef typename Inherited::Geometry1           Geometry1;
+    typedef typename Inherited::Derivative1         Derivative1;
+    typedef typename Inherited::Geometry2           Geometry2;
+    typedef typename Inherited::Derivative2         Derivative2;
+    
+    Constraint() {};
+    
+    Scalar calculateError(Geometry1& g1, Geometry2& g2) {        
+        return (g1.center()-g2.center()).norm() - g1.radius() - g2.radius() - Inherited::distance();
+    };
+
+    Scalar calculateGradientFirst(Geometry1& g1, Geometry2& g2, Derivative1& dg1) {        
+        return (g1.center()-g2.center()).dot(dg1.center()) / (g1.center()-g2.center()).norm() - dg1.radius();
+    };
+
+    Scalar calculateGradientSecond(Geometry1& g1, Geometry2& g2, Derivative2& dg2) {        
+        return (g1.center()-g2.center()).dot(-dg2.center()) / (g1.center()-g2.center()).norm() - dg2.radius();
+    };
+
+    Vector calculateGradientFirstComplete(Geometry1& g1, Geometry2& g2) {
+        Vector grad(3);
+        grad.template head<2>() = (g1.center()-g2.center()) / (g1.center()-g2.center()).norm();
+        grad(2) = -1;
+        return grad;
+    };
+
+    Vector calculateGradientSecondComplete(Geometry1& g1, Geometry2& g2) {
+        Vector grad(3);
+        grad.template head<2>() = (g2.center()-g1.center()) / (g1.center()-g2.center()).norm();
+        grad(2) = -1;
+        return grad;
+    };
+};
+
+}//numeric
+}//dcm
+
+#endif //DCM_DISTANCE_2D_H
@@ -0,0 +1,150 @@
+/*
+    openDCM, dimensional constraint manager
+    Copyright (C) 2015  Stefan Troeger <stefantroeger@gmx.net>
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along
+    with this library; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef DCM_GEOMETRY_2D_H
+#define DCM_GEOMETRY_2D_H
+
+#include <opendcm/core/geometry.hpp>
+#include <opendcm/core/constraint.hpp>
+#include <boost/fusion/include/at_c.hpp>
+
+namespace fusion = boost::fusion;
+
+namespace dcm {
+
+//the geometry primitives we handle in the 2d module. All of them use fixed size 2D storage, hence a 
+//sketch entity carries only the parameters it really needs
+namespace geometry {
+
+template<typename Kernel>
+struct Point2 : public Geometry<Kernel, numeric::Vector<Kernel, 2>> {
+
+    typedef typename Kernel::Scalar Scalar;
+    using Geometry<Kernel, numeric::Vector<Kernel, 2>>::m_storage;
+
+    auto point() -> decltype(fusion::at_c<0>(m_storage)) {
+        return fusion::at_c<0>(m_storage);
+    };
+    
+    Point2<Kernel>& transform(const details::Transform<Scalar, 2>& t) {
+        point() = t*point();
+        return *this;
+    };
+
+    Point2<Kernel>  transformed(const details::Transform<Scalar, 2>& t) {
+        Point2<Kernel> copy(*this);
+        copy.transform(t);
+        return copy;
+    };
+};
+
+template<typename Kernel>
+struct Line2 : public Geometry<Kernel, numeric::Vector<Kernel, 2>, numeric::Vector<Kernel, 2>> {
+
+    typedef typename Kernel::Scalar Scalar;
+    using Geometry<Kernel, numeric::Vector<Kernel, 2>, numeric::Vector<Kernel, 2>>::m_storage;
+
+    auto point() -> decltype(fusion::at_c<0>(m_storage)) {
+        return fusion::at_c<0>(m_storage);
+    };
+
+    auto direction() -> decltype(fusion::at_c<1>(m_storage)) {
+        return fusion::at_c<1>(m_storage);
+    };
+    
+    Line2<Kernel>& transform(const details::Transform<Scalar, 2>& t) {
+        point() = t*point();
+        t.rotate(direction());
+        return *this;
+    };
+
+    Line2<Kernel>  transformed(const details::Transform<Scalar, 2>& t) {
+        Line2<Kernel> copy(*this);
+        copy.transform(t);
+        return copy;
+    };
+};
+
+template<typename Kernel>
+struct Circle2 : public Geometry<Kernel, numeric::Vector<Kernel, 2>, typename Kernel::Scalar> {
+
+    typedef typename Kernel::Scalar Scalar;
+    using Geometry<Kernel, numeric::Vector<Kernel, 2>, Scalar>::m_storage;
+
+    auto center() -> decltype(fusion::at_c<0>(m_storage)) {
+        return fusion::at_c<0>(m_storage);
+    };
+
+    auto radius() -> decltype(fusion::at_c<1>(m_storage)) {
+        return fusion::at_c<1>(m_storage);
+    };
+    
+    Circle2<Kernel>& transform(const details::Transform<Scalar, 2>& t) {
+        center() = t*center();
+        radius() *= t.scaling().factor();
+        return *this;
+    };
+
+    Circle2<Kernel>  transformed(const details::Transform<Scalar, 2>& t) {
+        Circle2<Kernel> copy(*this);
+        copy.transform(t);
+        return copy;
+    };
+};
+
+}//geometry
+
+namespace numeric {
+namespace detail2d {
+
+//the 2D cross product, which is the z component of the 3D one, gives the signed area spanned by the 
+//vectors and is used for all line distance and orientation equations
+template<typename T1, typename T2>
+inline typename T1::Scalar cross(const Eigen::MatrixBase<T1>& v1, const Eigen::MatrixBase<T2>& v2) {
+    return v1(0)*v2(1) - v1(1)*v2(0);
+};
+
+//derivative helper: d cross(v1, v2)/d v1 = perp(v2) and d cross(v1, v2)/d v2 = -perp(v1)
+template<typename T>
+inline Eigen::Matrix<typename T::Scalar, 2, 1> perp(const Eigen::MatrixBase<T>& v) {
+    return Eigen::Matrix<typename T::Scalar, 2, 1>(v(1), -v(0));
+};
+
+}//detail2d
+
+//angle and orientation constraints between two lines need the same direction products
+template<typename Kernel>
+struct SharedTerms<Kernel, geometry::Line2<Kernel>, geometry::Line2<Kernel>> {
+    
+    typedef typename Kernel::Scalar Scalar;
+    
+    Scalar dot, cross, norm1, norm2;
+    
+    void update(geometry::Line2<Kernel>& g1, geometry::Line2<Kernel>& g2) {
+        dot   = g1.direction().dot(g2.direction());
+        cross = detail2d::cross(g1.direction(), g2.direction());
+        norm1 = g1.direction().norm();
+        norm2 = g2.direction().norm();
+    };
+};
+
+}//numeric
+}//dcm
+
+#endif //DCM_GEOMETRY_2D_H
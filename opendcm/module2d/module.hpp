@@ -0,0 +1,56 @@
+/*
+    openDCM, dimensional constraint manager
+    Copyright (C) 2015  Stefan Troeger <stefantroeger@gmx.net>
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along
+    with this library; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef DCM_MODULE_2D_H
+#define DCM_MODULE_2D_H
+
+#include "opendcm/core/module.hpp"
+
+#include "geometry.hpp"
+#include "distance.hpp"
+#include "angle.hpp"
+#include "orientation.hpp"
+
+namespace dcm {
+    
+/**
+ * @brief Module for planar sketches
+ * 
+ * Adds the 2D primitive geometries to the system. All of them are based on fixed size 2D storage and all
+ * constraint equations between them use fixed size 2D math, hence a sketch does not need to be emulated
+ * with 3D geometries and additional planarity constraints.
+ * Supported geometries are \ref geometry::Point2, \ref geometry::Line2 and \ref geometry::Circle2, arcs
+ * can be build from a circle and two points with zero distance to it. The supported constraints are
+ * dcm::Distance for all point, line and circle combinations (except line-line) and dcm::Angle and 
+ * dcm::Orientation between lines.
+ */
+struct Module2D {
+
+    typedef boost::mpl::int_<4> ID;
+
+    template<typename Final, typename Stacked>
+    struct type : public Stacked {
+
+        DCM_MODULE_ADD_GEOMETRIES(Stacked, (geometry::Point2)(geometry::Line2)(geometry::Circle2))
+    };
+};
+
+}//dcm
+
+#endif //DCM_MODULE_2D_H
@@ -0,0 +1,122 @@
+/*
+    openDCM, dimensional constraint manager
+    Copyright (C) 2015  Stefan Troeger <stefantroeger@gmx.net>
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along
+    with this library; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef DCM_ORIENTATION_2D_H
+#define DCM_ORIENTATION_2D_H
+
+#include <opendcm/core/constraint.hpp>
+#include "geometry.hpp"
+
+#include <cmath>
+
+namespace dcm {
+namespace numeric {
+
+//In 2D the orientation between two directions is fully described by a single angle, hence all 
+//orientations can be expressed by one scalar equation with full rank at the solution. Equal and 
+//opposite use the signed angle between the directions (respectivly between d1 and -d2), parallel 
+//chooses the closer one of both. Perpendicular uses the cosine.
+template<typename Kernel>
+struct Constraint<Kernel, dcm::Orientation, geometry::Line2<Kernel>, geometry::Line2<Kernel>> 
+    : public ConstraintBase<Kernel, dcm::Orientation, geometry::Line2<Kernel>, geometry::Line2<Kernel>> {
+  
+    typedef ConstraintBase<Kernel, dcm::Orientation, geometry::Line2<Kernel>, geometry::Line2<Kernel>> Inherited;
+    typedef typename Kernel::Scalar                 Scalar;
+    typedef typename Inherited::Vector              Vector;
+    typedef typename Inherited::Geometry1           Geometry1;
+    typedef typename Inherited::Derivative1         Derivative1;
+    typedef typename Inherited::Geometry2           Geometry2;
+    typedef typename Inherited::Derivative2         Derivative2;
+    typedef Eigen::Matrix<Scalar, 2, 1>             Vector2;
+    
+    Constraint() {};
+    
+    Scalar calculateError(Geometry1& g1, Geometry2& g2) {
+        
+        const auto& t = Inherited::terms(g1, g2);
+        
+        if(Inherited::orientation() == Orientations::Perpendicular)
+            return t.dot / (t.norm1*t.norm2);
+        
+        if(opposite(t.dot))
+            return std::atan2(-t.cross, -t.dot);
+        
+        return std::atan2(t.cross, t.dot);
+    };
+
+    Scalar calculateGradientFirst(Geometry1& g1, Geometry2& g2, Derivative1& dg1) {
+        return gradientFirst(g1.direction(), g2.direction(), Inherited::terms(g1, g2)).dot(dg1.direction());
+    };
+
+    Scalar calculateGradientSecond(Geometry1& g1, Geometry2& g2, Derivative2& dg2) {
+        return gradientSecond(g1.direction(), g2.direction(), Inherited::terms(g1, g2)).dot(dg2.direction());
+    };
+
+    Vector calculateGradientFirstComplete(Geometry1& g1, Geometry2& g2) {
+        Vector grad(4);
+        grad.template head<2>().setZero();
+        grad.template tail<2>() = gradientFirst(g1.direction(), g2.direction(), Inherited::terms(g1, g2));
+        return grad;
+    };
+
+    Vector calculateGradientSecondComplete(Geometry1& g1, Geometry2& g2) {
+        Vector grad(4);
+        grad.template head<2>().setZero();
+        grad.template tail<2>() = gradientSecond(g1.direction(), g2.direction(), Inherited::terms(g1, g2));
+        return grad;
+    };
+    
+private:
+    typedef typename Inherited::Terms Terms;
+    
+    bool opposite(Scalar dot) {
+        
+        switch(Inherited::orientation()) {
+            case Orientations::Opposite:
+                return true;
+            case Orientations::Parallel:
+                return dot < 0;
+            default:
+                return false;
+        };
+    };
+    
+    //The derivative of the signed angle is the same for d2 and -d2, hence we can ignore the 
+    //orientation type for it. For perpendicular we need the cosine derivative
+    Vector2 gradientFirst(const Vector2& d1, const Vector2& d2, const Terms& t) {
+        
+        if(Inherited::orientation() == Orientations::Perpendicular) 
+            return d2/(t.norm1*t.norm2) - t.dot*d1/(std::pow(t.norm1,3)*t.norm2);
+        
+        return (t.dot*detail2d::perp(d2) - t.cross*d2) / std::pow(t.norm1*t.norm2, 2);
+    };
+    
+    Vector2 gradientSecond(const Vector2& d1, const Vector2& d2, const Terms& t) {
+        
+        if(Inherited::orientation() == Orientations::Perpendicular) 
+            return d1/(t.norm1*t.norm2) - t.dot*d2/(std::pow(t.norm2,3)*t.norm1);
+        
+        return (-t.dot*detail2d::perp(d1) - t.cross*d1) / std::pow(t.norm1*t.norm2, 2);
+    };
+};
+
+}//numeric
+}//dcm
+
+#endif //DCM_ORIENTATION_2D_H
@@ -0,0 +1,232 @@
+/*
+    openDCM, dimensional constraint manager
+    Copyright (C) 2015  Stefan Troeger <stefantroeger@gmx.net>
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along
+    with this library; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <boost/test/unit_test.hpp>
+
+#include "opendcm/core/kernel.hpp"
+#include "opendcm/core/cholesky.hpp"
+
+#include <random>
+#include <atomic>
+
+typedef dcm::Eigen3Kernel<double> K;
+typedef std::vector<std::vector<int>> Adjacency;
+
+//jacobian of distance like constraints between the blocks of a size x size grid
+Eigen::SparseMatrix<double> gridJacobian(int size, const std::vector<int>& blockSizes, Adjacency& adj) {
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> dist(-1, 1);
+
+    std::vector<int> start(blockSizes.size());
+    int cols = 0;
+    for(int i=0; i<blockSizes.size(); ++i) {
+        start[i] = cols;
+        cols += blockSizes[i];
+    }
+
+    adj.assign(size*size, std::vector<int>());
+    std::vector<Eigen::Triplet<double>> triplets;
+    int row = 0;
+    auto couple = [&](int a, int b) {
+        adj[a].push_back(b);
+        adj[b].push_back(a);
+        for(int r=0; r<3; ++r, ++row) {
+            for(int i=0; i<blockSizes[a]; ++i)
+                triplets.emplace_back(row, start[a]+i, dist(gen));
+            for(int i=0; i<blockSizes[b]; ++i)
+                triplets.emplace_back(row, start[b]+i, dist(gen));
+        }
+    };
+    for(int i=0; i<size; ++i) {
+        for(int j=0; j<size; ++j) {
+            if(i+1 < size)
+                couple(i*size+j, (i+1)*size+j);
+            if(j+1 < size)
+                couple(i*size+j, i*size+j+1);
+        }
+    }
+
+    Eigen::SparseMatrix<double> J(row, cols);
+    J.setFromTriplets(triplets.begin(), triplets.end());
+    return J;
+};
+
+BOOST_AUTO_TEST_SUITE(Cholesky_test_suit);
+
+BOOST_AUTO_TEST_CASE(block_cholesky) {
+
+    //mixed cluster and point blocks
+    const int size = 12;
+    std::vector<int> sizes(size*size);
+    for(int i=0; i<sizes.size(); ++i)
+        sizes[i] = (i%3 == 0) ? 6 : 3;
+
+    Adjacency adj;
+    Eigen::SparseMatrix<double> J = gridJacobian(size, sizes, adj);
+    const double damping = 1e-3;
+
+    Eigen::MatrixXd A = Eigen::MatrixXd(J.transpose()*J) + damping*Eigen::MatrixXd::Identity(J.cols(), J.cols());
+    Eigen::VectorXd b = Eigen::VectorXd::Random(J.cols());
+    Eigen::VectorXd reference = A.llt().solve(b);
+
+    dcm::numeric::BlockCholesky<K> chol;
+    chol.analyze(sizes, adj);
+    chol.factorizeNormal(J, damping);
+    BOOST_REQUIRE(chol.info() == Eigen::Success);
+    BOOST_CHECK(chol.solve(b).isApprox(reference, 1e-8));
+
+    //the sequential factorization must give the same result
+    chol.parallel = false;
+    chol.factorizeNormal(J, damping);
+    BOOST_REQUIRE(chol.info() == Eigen::Success);
+    BOOST_CHECK(chol.solve(b).isApprox(reference, 1e-8));
+
+    //a nested dissection order creates less fill and a bushy elimination tree
+    std::vector<int> order = dcm::numeric::ordering::nestedDissection(adj);
+    std::vector<int> permutation = dcm::numeric::ordering::parameterPermutation(order, sizes);
+    std::vector<int> blockPosition(order.size()), orderedSizes(order.size());
+    for(int i=0; i<order.size(); ++i) {
+        blockPosition[order[i]] = i;
+        orderedSizes[i] = sizes[order[i]];
+    }
+    Adjacency orderedAdj(adj.size());
+    for(int i=0; i<adj.size(); ++i)
+        for(int n : adj[i])
+            orderedAdj[blockPosition[i]].push_back(blockPosition[n]);
+
+    Eigen::PermutationMatrix<Eigen::Dynamic> P(permutation.size());
+    for(int i=0; i<permutation.size(); ++i)
+        P.indices()(i) = permutation[i];
+
+    Eigen::SparseMatrix<double> PJ = J*P.transpose();
+    dcm::numeric::BlockCholesky<K> ndchol;
+    ndchol.parallel = true;
+    ndchol.grainsize = 4;
+    ndchol.analyze(orderedSizes, orderedAdj);
+    ndchol.factorizeNormal(PJ, damping);
+    BOOST_REQUIRE(ndchol.info() == Eigen::Success);
+    BOOST_CHECK((P.transpose()*ndchol.solve(Eigen::VectorXd(P*b))).isApprox(reference, 1e-8));
+    BOOST_CHECK(ndchol.factorBlocks() < chol.factorBlocks());
+
+    int roots = 0;
+    std::vector<bool> child(order.size(), false);
+    for(auto& c : ndchol.children())
+        for(int n : c)
+            child[n] = true;
+    for(bool c : child)
+        roots += c ? 0 : 1;
+    BOOST_CHECK(roots == 1);
+    BOOST_CHECK(ndchol.children()[order.size()-1].size() >= 1);
+}
+
+BOOST_AUTO_TEST_CASE(block_cholesky_indefinite) {
+
+    std::vector<int> sizes = {3, 3};
+    Adjacency adj = {{1}, {0}};
+
+    Eigen::MatrixXd A = Eigen::MatrixXd::Identity(6,6);
+    A(4,4) = -1;
+
+    dcm::numeric::BlockCholesky<K> chol;
+    chol.analyze(sizes, adj);
+    chol.factorize(A.sparseView());
+    BOOST_CHECK(chol.info() == Eigen::NumericalIssue);
+}
+
+BOOST_AUTO_TEST_CASE(block_cholesky_chain) {
+
+    //blocks coupled in a chain and kept in natural order give an elimination tree as deep as the chain
+    const int count = 200000;
+    std::vector<int> sizes(count, 2);
+    Adjacency adj(count);
+    std::vector<Eigen::Triplet<double>> triplets;
+    for(int i=0; i<count; ++i) {
+        for(int k=0; k<2; ++k) {
+            triplets.emplace_back(2*i+k, 2*i+k, 4);
+            if(i+1 < count) {
+                triplets.emplace_back(2*i+k, 2*i+2+k, -1);
+                triplets.emplace_back(2*i+2+k, 2*i+k, -1);
+            }
+        }
+        if(i+1 < count) {
+            adj[i].push_back(i+1);
+            adj[i+1].push_back(i);
+        }
+    }
+    Eigen::SparseMatrix<double> A(2*count, 2*count);
+    A.setFromTriplets(triplets.begin(), triplets.end());
+    Eigen::VectorXd b = Eigen::VectorXd::Random(2*count);
+
+    dcm::numeric::BlockCholesky<K> chol;
+    chol.parallel = true;
+    chol.analyze(sizes, adj);
+    BOOST_CHECK(chol.children()[count-1].size() == 1);
+    chol.factorize(A);
+    BOOST_REQUIRE(chol.info() == Eigen::Success);
+    BOOST_CHECK((A*chol.solve(b)).isApprox(b, 1e-10));
+
+    //every node is processed exactly once and after all of its children, also below the grainsize
+    for(int grainsize : {0, 1, 16, 2*count}) {
+        std::vector<std::atomic<int>> position(count);
+        std::atomic<int> next(0);
+        dcm::shedule::for_each_postorder(chol.children(), {count-1}, [&](int j) {position[j] = next++;}, 
+                                         grainsize);
+        int misplaced = 0;
+        for(int j=0; j<count; ++j)
+            misplaced += (position[j] != j) ? 1 : 0;
+        BOOST_CHECK(next == count);
+        BOOST_CHECK(misplaced == 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(domain_decomposition) {
+
+    const int size = 16;
+    std::vector<int> sizes(size*size);
+    for(int i=0; i<sizes.size(); ++i)
+        sizes[i] = (i%4 == 0) ? 6 : 3;
+
+    Adjacency adj;
+    Eigen::SparseMatrix<double> J = gridJacobian(size, sizes, adj);
+    const double damping = 1e-3;
+
+    Eigen::MatrixXd A = Eigen::MatrixXd(J.transpose()*J) + damping*Eigen::MatrixXd::Identity(J.cols(), J.cols());
+    Eigen::VectorXd b = Eigen::VectorXd::Random(J.cols());
+    Eigen::VectorXd reference = A.llt().solve(b);
+
+    dcm::numeric::DomainDecomposition<K> dd;
+    dd.domains = 4;
+    dd.analyze(sizes, adj);
+    BOOST_CHECK(dd.separatorSize() > 0);
+    BOOST_CHECK(dd.separatorSize() < J.cols()/4);
+    for(int d=0; d<4; ++d)
+        BOOST_CHECK(std::count(dd.parts().begin(), dd.parts().end(), d) > 0);
+
+    dd.factorizeNormal(J, damping);
+    BOOST_REQUIRE(dd.info() == Eigen::Success);
+    BOOST_CHECK(dd.solve(b).isApprox(reference, 1e-8));
+
+    dd.parallel = false;
+    dd.factorize(A.sparseView());
+    BOOST_REQUIRE(dd.info() == Eigen::Success);
+    BOOST_CHECK(dd.solve(b).isApprox(reference, 1e-8));
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -29,6 +29,10 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <thread>
+#include <random>
+#include <algorithm>
+
 using namespace dcm;
 using namespace graph;
 namespace mpl = boost::mpl;
@@ -501,6 +505,15 @@ BOOST_AUTO_TEST_CASE(move_cluster) {
     //check subcluster 3
     BOOST_CHECK(sub3.first->edgeCount() == 1);
     BOOST_CHECK(sub3.first->vertexCount() == 2);
+    
+    //the moved vertex must still point to its cluster
+    BOOST_CHECK(g->numClusters() == 2);
+    BOOST_CHECK(sub3.first->numClusters() == 1);
+    BOOST_CHECK(sub3.first->isCluster(nv));
+    BOOST_CHECK(!sub3.first->isCluster(fusion::at_c<0>(v5)));
+    BOOST_CHECK(sub3.first->getVertexCluster(nv) == sub2.first);
+    BOOST_CHECK(sub3.first->clusters().first->first == nv);
+    BOOST_CHECK(sub2.first->parent() == sub3.first);
 
     //nv to v5 should have one global edge
     LocalEdge et3 = sub3.first->edge(nv, fusion::at_c<0>(v5)).first;
@@ -516,6 +529,12 @@ BOOST_AUTO_TEST_CASE(move_cluster) {
     BOOST_CHECK(g->vertexCount() == 5);
     BOOST_CHECK(sub3.first->edgeCount() == 0);
     BOOST_CHECK(sub3.first->vertexCount() == 1);
+    BOOST_CHECK(g->numClusters() == 3);
+    BOOST_CHECK(sub3.first->numClusters() == 0);
+    BOOST_CHECK(g->getVertexCluster(nc) == sub2.first);
+    BOOST_CHECK(g->getClusterVertex(sub2.first) == nc);
+    BOOST_CHECK(sub2.first->parent() == g);
+    BOOST_CHECK(!g->isCluster(fusion::at_c<0>(v1)));
 
     //nc to sub1 should have one global edge
     std::pair<LocalEdge, bool> res = g->edge(nc, sub1.second);
@@ -554,6 +573,127 @@ BOOST_AUTO_TEST_CASE(move_cluster) {
     BOOST_CHECK(++it.first == it.second);
 }
 
+BOOST_AUTO_TEST_CASE(neighbour_hash) {
+
+    std::shared_ptr<Graph> g = std::shared_ptr<Graph>(new Graph);
+    LocalVertex center = fusion::at_c<0>(g->addVertex());
+    
+    //a star graph, the center gets a hash above the default degree
+    std::vector<LocalVertex> leaves;
+    std::vector<GlobalEdge>  edges;
+    for(int i=0; i<100; ++i) {
+        leaves.push_back(fusion::at_c<0>(g->addVertex()));
+        edges.push_back(fusion::at_c<1>(g->addEdge(center, leaves.back())));
+    }
+    BOOST_CHECK(g->hasNeighbourHash(center));
+    BOOST_CHECK(!g->hasNeighbourHash(leaves.front()));
+    
+    for(int i=0; i<100; ++i) {
+        std::pair<LocalEdge, bool> e = g->edge(leaves[i], center);
+        BOOST_REQUIRE(e.second);
+        BOOST_CHECK(g->source(e.first) == leaves[i]);
+        BOOST_CHECK(g->target(e.first) == center);
+        BOOST_CHECK(*g->getGlobalEdges(e.first).first == edges[i]);
+        BOOST_CHECK(g->edge(center, leaves[i]).second);
+    }
+    BOOST_CHECK(!g->edge(leaves[0], leaves[1]).second);
+    
+    //structure changes must be reflected in the hash
+    g->removeEdge(edges[5]);
+    BOOST_CHECK(!g->edge(center, leaves[5]).second);
+    BOOST_CHECK(fusion::at_c<2>(g->addEdge(leaves[5], center)));
+    BOOST_CHECK(g->edge(center, leaves[5]).second);
+    
+    g->removeVertex(leaves[6]);
+    LocalVertex v = fusion::at_c<0>(g->addVertex());
+    BOOST_CHECK(!g->edge(center, v).second);
+    BOOST_CHECK(g->outDegree(center) == 99);
+    
+    //moving the center connects all leaves to the cluster vertex, which now needs a hash
+    std::pair<std::shared_ptr<Graph>, LocalVertex> sub = g->createCluster();
+    g->moveToSubcluster(center, sub.second);
+    BOOST_CHECK(g->hasNeighbourHash(sub.second));
+    for(int i=0; i<100; ++i) {
+        if(i != 6)
+            BOOST_CHECK(g->edge(leaves[i], sub.second).second);
+    }
+    BOOST_CHECK(!g->edge(v, sub.second).second);
+    
+    //disabled hashing gives the same results
+    g->setNeighbourHashDegree(0);
+    BOOST_CHECK(!g->hasNeighbourHash(sub.second));
+    BOOST_CHECK(g->edge(leaves[0], sub.second).second);
+    BOOST_CHECK(!g->edge(v, sub.second).second);
+}
+
+//a size class which is used by this test only
+struct PoolNode {
+    char data[1000];
+};
+typedef dcm::graph::NodeAllocator<PoolNode> PoolAllocator;
+
+BOOST_AUTO_TEST_CASE(node_pool) {
+
+    //the checks run in a fresh thread, so that they do not depend on the cache state left by other tests
+    int neighbours = 0, ascending = 0;
+    bool reused = false, vertexReused = false;
+    std::thread([&]() {
+        
+        //nodes created after each other are neighbours in memory, the list node holds the links too
+        std::list<PoolNode, PoolAllocator> list;
+        list.push_back(PoolNode());
+        for(int i=0; i<20; ++i) {
+            PoolNode* last = &list.back();
+            list.push_back(PoolNode());
+            const std::ptrdiff_t stride = (char*)&list.back() - (char*)last;
+            if(stride > 0 && stride < std::ptrdiff_t(sizeof(PoolNode) + 4*sizeof(void*)))
+                ++neighbours;
+        }
+        
+        //freed nodes get reused
+        PoolNode* last = &list.back();
+        list.pop_back();
+        list.push_back(PoolNode());
+        reused = &list.back() == last;
+        
+        //after freeing many nodes in random order they are handed out in address order again
+        std::vector<PoolNode*> nodes;
+        PoolAllocator alloc;
+        for(int i=0; i<200; ++i)
+            nodes.push_back(alloc.allocate(1));
+        std::shuffle(nodes.begin(), nodes.end(), std::mt19937(42));
+        for(PoolNode* n : nodes)
+            alloc.deallocate(n, 1);
+        
+        PoolNode* previous = alloc.allocate(1);
+        for(int i=1; i<200; ++i) {
+            PoolNode* n = alloc.allocate(1);
+            if(n > previous)
+                ++ascending;
+            previous = n;
+        }
+        
+        //the graph nodes are drawn from the pool too
+        std::shared_ptr<Graph> g = std::shared_ptr<Graph>(new Graph);
+        LocalVertex v1 = fusion::at_c<0>(g->addVertex());
+        g->removeVertex(v1);
+        LocalVertex v2 = fusion::at_c<0>(g->addVertex());
+        vertexReused = v1 == v2;
+    }).join();
+    
+    BOOST_CHECK_EQUAL(neighbours, 20);
+    BOOST_CHECK(reused);
+    BOOST_CHECK_EQUAL(ascending, 199);
+    BOOST_CHECK(vertexReused);
+    
+    //nodes released after the thread cache is destructed, like by objects destroyed at program exit
+    std::thread([]() {
+        static thread_local std::list<PoolNode, PoolAllocator> late;
+        late.push_back(PoolNode());
+        late.push_back(PoolNode());
+    }).join();
+}
+
 BOOST_AUTO_TEST_CASE(filter_graph) {
     
     std::shared_ptr<Graph> g1 = std::shared_ptr<Graph>(new Graph);
@@ -169,7 +169,138 @@ BOOST_AUTO_TEST_CASE(numeric) {
    BOOST_CHECK_NO_THROW(gc_constraint->calculate());
    
    BOOST_CHECK(gg_constraint->getResidual() == 1);
+   
+   //soft constraints mark their residual in the system
+   std::shared_ptr<ggc> soft_constraint(new ggc());
+   soft_constraint->setInputEquations(p1, p2);
+   soft_constraint->setWeight(2.5, 3);
+   soft_constraint->init(sys);
+   BOOST_CHECK(sys.weights()(4) == 2.5);
+   BOOST_CHECK(sys.priorities()(4) == 3);
+   BOOST_CHECK(sys.priorities().head<4>().isZero());
+   BOOST_CHECK(sys.hasSoftResiduals());
+
+}
+
+BOOST_AUTO_TEST_CASE(fixed_input) {
+    
+   typedef dcm::numeric::Geometry<K, TPoint3>  Point;
+   typedef dcm::numeric::Equation<K, TPoint3<K>> FixedPoint;
+   typedef dcm::numeric::TypedConstraintEquationGenerator<K, dcm::Distance, TPoint3<K>, TPoint3<K>> Generator;
+   typedef dcm::numeric::ConstraintEquationBase<K, dcm::Distance, TPoint3<K>, TPoint3<K>> Base;
+    
+   dcm::numeric::LinearSystem<K> sys(20,20);  
+   std::shared_ptr<Point> p1(new Point);
+   std::shared_ptr<FixedPoint> fixed(new FixedPoint), fixed2(new FixedPoint);
+   p1->init(sys);
+   p1->value() = Eigen::Vector3d(2,0,0);
+   fixed->value() = Eigen::Vector3d(0,0,0);
+   fixed2->value() = Eigen::Vector3d(0,1,0);
+   BOOST_CHECK(fixed->getComplexity() == dcm::numeric::Complexity::Fixed);
+   
+   dcm::symbolic::TypeConstraint<dcm::Distance> symbolic;
+   symbolic.setPrimitiveConstraint(dcm::Distance(1, dcm::SolutionSpaces::Bidirectional));
+   Generator generator;
+   
+   //a fixed first input gives a unary equation, which only calculates the free derivatives
+   auto eqn = generator.buildEquation(fixed, p1, &symbolic);
+   typedef dcm::numeric::ConstraintFixedFirstEquation<K, dcm::Distance, TPoint3<K>, TPoint3<K>, true> FixedFirst;
+   auto fixedFirst = std::dynamic_pointer_cast<FixedFirst>(eqn);
+   BOOST_REQUIRE(fixedFirst);
+   fixedFirst->init(sys);
+   fixedFirst->execute();
+   BOOST_CHECK_CLOSE(fixedFirst->getResidual(), 1, 1e-10);
+   BOOST_CHECK(fixedFirst->getFirstDerivatives().empty());
+   BOOST_CHECK(fixedFirst->getSecondDerivatives().size() == 3);
+   
+   //same for the second input
+   eqn = generator.buildEquation(p1, fixed, &symbolic);
+   auto fixedSecond = std::dynamic_pointer_cast<Base>(eqn);
+   BOOST_REQUIRE(fixedSecond);
+   typedef dcm::numeric::ConstraintFixedSecondEquation<K, dcm::Distance, TPoint3<K>, TPoint3<K>, true> FixedSecond;
+   BOOST_CHECK(std::dynamic_pointer_cast<FixedSecond>(eqn));
+   fixedSecond->init(sys);
+   fixedSecond->execute();
+   BOOST_CHECK_CLOSE(fixedSecond->getResidual(), 1, 1e-10);
+   BOOST_CHECK(fixedSecond->getSecondDerivatives().empty());
+   BOOST_CHECK(fixedSecond->getFirstDerivatives().size() == 3);
+   BOOST_CHECK_CLOSE(*fixedSecond->getFirstDerivatives()[0].second.Value, 1, 1e-10);
+   
+   //a residual only evaluation leaves the jacobian untouched, a derivative only one the residual
+   p1->value() = Eigen::Vector3d(3,0,0);
+   *fixedSecond->getFirstDerivatives()[0].second.Value = 0;
+   sys.setEvaluation(dcm::numeric::Evaluation::Residuals);
+   fixedSecond->execute();
+   BOOST_CHECK_CLOSE(fixedSecond->getResidual(), 2, 1e-10);
+   BOOST_CHECK_EQUAL(*fixedSecond->getFirstDerivatives()[0].second.Value, 0);
+   p1->value() = Eigen::Vector3d(5,0,0);
+   sys.setEvaluation(dcm::numeric::Evaluation::Derivatives);
+   fixedSecond->execute();
+   sys.setEvaluation(dcm::numeric::Evaluation::Full);
+   BOOST_CHECK_CLOSE(fixedSecond->getResidual(), 2, 1e-10);
+   BOOST_CHECK_CLOSE(*fixedSecond->getFirstDerivatives()[0].second.Value, 1, 1e-10);
+   fixedSecond->execute();
+   BOOST_CHECK_CLOSE(fixedSecond->getResidual(), 4, 1e-10);
+   
+   //constraints between fixed inputs are folded away
+   BOOST_CHECK(!generator.buildEquation(fixed, fixed2, &symbolic));
+   
+   dcm::shedule::FlowGraph flow;
+   BOOST_CHECK(!generator.buildEquationNode(fixed, fixed2, &symbolic, flow).first);
+   BOOST_CHECK(generator.buildEquationNode(fixed, p1, &symbolic, flow).first);
+}
 
+BOOST_AUTO_TEST_CASE(parallel_assembly) {
+    
+    typedef dcm::numeric::Geometry<K, TPoint3>                                                   Point;
+    typedef dcm::numeric::ConstraintComplexEquation<K, dcm::Distance, TPoint3<K>, TPoint3<K>>  Distance;
+    
+    const int count = 500;
+    dcm::numeric::LinearSystem<K> sys(3*count, count-1);
+    
+    std::vector<std::shared_ptr<Point>>    points;
+    std::vector<std::shared_ptr<Distance>> constraints;
+    for(int i=0; i<count; ++i) {
+        points.emplace_back(new Point);
+        points.back()->init(sys);
+    }
+    for(int i=1; i<count; ++i) {
+        constraints.emplace_back(new Distance);
+        constraints.back()->setInputEquations(points[i-1], points[i]);
+        constraints.back()->distance() = 1;
+        constraints.back()->init(sys);
+    }
+    sys.parameter().setRandom();
+    
+    //the reference is a sequential evaluation
+    for(auto& p : points)
+        p->execute();
+    for(auto& c : constraints)
+        c->execute();
+    
+    const Eigen::VectorXd residuals = sys.residuals();
+    const Eigen::MatrixXd jacobi    = sys.jacobi();
+    sys.residuals().setZero();
+    sys.jacobi().setZero();
+    
+    //geometries first, constraints afterwards
+    dcm::shedule::LevelVector assembly(16);
+    for(auto& p : points)
+        assembly.add(0, [=]() {p->execute();});
+    for(auto& c : constraints)
+        assembly.add(1, [=]() {c->execute();});
+    
+    BOOST_CHECK(assembly.levels() == 2);
+    assembly();
+    
+    BOOST_CHECK(sys.residuals().isApprox(residuals));
+    BOOST_CHECK(sys.jacobi().isApprox(jacobi));
+    
+    //parameter changes must be picked up by the geometries before the constraints are evaluated
+    sys.parameter().setRandom();
+    assembly();
+    for(int i=1; i<count; ++i) 
+        BOOST_CHECK_CLOSE(sys.residuals()(i-1)+1, (points[i-1]->value()-points[i]->value()).norm(), 1e-10);
 }
 
 BOOST_AUTO_TEST_SUITE_END();
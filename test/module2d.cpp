@@ -0,0 +1,256 @@
+/*
+    openDCM, dimensional constraint manager
+    Copyright (C) 2015  Stefan Troeger <stefantroeger@gmx.net>
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along
+    with this library; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <boost/test/unit_test.hpp>
+
+#include "opendcm/core.hpp"
+#include "opendcm/module2d.hpp"
+
+typedef dcm::Eigen3Kernel<double> K;
+typedef Eigen::VectorXd           Vector;
+
+//helpers to access the 2d primitives as flat parameter vector 
+void set(dcm::geometry::Point2<K>& g, const Vector& v) {
+    g.point() = v.head<2>();
+};
+void set(dcm::geometry::Line2<K>& g, const Vector& v) {
+    g.point() = v.head<2>();
+    g.direction() = v.segment<2>(2);
+};
+void set(dcm::geometry::Circle2<K>& g, const Vector& v) {
+    g.center() = v.head<2>();
+    g.radius() = v(2);
+};
+
+//check the analytic derivatives against the central differences of the error function. This covers
+//the complete and the single derivative functions as both must give the same values
+template<typename G1, typename G2, typename C>
+void checkGradients(C& c, const Vector& p1, const Vector& p2) {
+    
+    const double h = 1e-6;
+    G1 g1, g1h, dg1;
+    G2 g2, g2h, dg2;
+    set(g1, p1);
+    set(g2, p2);
+    
+    Vector grad1 = c.calculateGradientFirstComplete(g1, g2);
+    BOOST_REQUIRE(grad1.rows() == p1.rows());
+    for(int i=0; i<p1.rows(); ++i) {
+        
+        set(g1h, p1 + h*Vector::Unit(p1.rows(), i));
+        double e1 = c.calculateError(g1h, g2);
+        set(g1h, p1 - h*Vector::Unit(p1.rows(), i));
+        double e2 = c.calculateError(g1h, g2);
+        BOOST_CHECK_SMALL((e1-e2)/(2*h) - grad1(i), 1e-6);
+        
+        set(dg1, Vector::Unit(p1.rows(), i));
+        BOOST_CHECK_SMALL(c.calculateGradientFirst(g1, g2, dg1) - grad1(i), 1e-12);
+    }
+    
+    Vector grad2 = c.calculateGradientSecondComplete(g1, g2);
+    BOOST_REQUIRE(grad2.rows() == p2.rows());
+    for(int i=0; i<p2.rows(); ++i) {
+        
+        set(g2h, p2 + h*Vector::Unit(p2.rows(), i));
+        double e1 = c.calculateError(g1, g2h);
+        set(g2h, p2 - h*Vector::Unit(p2.rows(), i));
+        double e2 = c.calculateError(g1, g2h);
+        BOOST_CHECK_SMALL((e1-e2)/(2*h) - grad2(i), 1e-6);
+        
+        set(dg2, Vector::Unit(p2.rows(), i));
+        BOOST_CHECK_SMALL(c.calculateGradientSecond(g1, g2, dg2) - grad2(i), 1e-12);
+    }
+};
+
+using dcm::geometry::Point2;
+using dcm::geometry::Line2;
+using dcm::geometry::Circle2;
+
+BOOST_AUTO_TEST_SUITE(Module2D_test_suit);
+
+BOOST_AUTO_TEST_CASE(geometry) {
+    
+    typedef dcm::details::Transform<double, 2> Transform;
+    Transform t(Eigen::Rotation2D<double>(M_PI/2.), Transform::Translation(Eigen::Vector2d(1,0)));
+    
+    Point2<K> p;
+    p.point() = Eigen::Vector2d(1,0);
+    BOOST_CHECK(p.transformed(t).point().isApprox(Eigen::Vector2d(1,1)));
+    
+    Line2<K> l;
+    l.point() = Eigen::Vector2d(1,0);
+    l.direction() = Eigen::Vector2d(1,0);
+    l.transform(t);
+    BOOST_CHECK(l.point().isApprox(Eigen::Vector2d(1,1)));
+    BOOST_CHECK(l.direction().isApprox(Eigen::Vector2d(0,1)));
+    
+    Circle2<K> c;
+    c.center() = Eigen::Vector2d(0,0);
+    c.radius() = 2;
+    c.transform(t*Transform::Scaling(2.));
+    BOOST_CHECK(c.center().isApprox(Eigen::Vector2d(2,0)));
+    BOOST_CHECK(c.radius() == 4);
+}
+
+BOOST_AUTO_TEST_CASE(distance) {
+    
+    Vector p(2), l(4), c(3), c2(3);
+    p  << 1, 2;
+    l  << -1, 0.5, 2, 0.3;
+    c  << 3, -1, 0.5;
+    c2 << -2, -3, 1.2;
+    
+    dcm::numeric::Constraint<K, dcm::Distance, Point2<K>, Point2<K>> pp;
+    pp.distance() = 1;
+    Point2<K> p1, p2;
+    p1.point() = Eigen::Vector2d(0,0);
+    p2.point() = Eigen::Vector2d(3,4);
+    BOOST_CHECK_CLOSE(pp.calculateError(p1, p2), 4, 1e-10);
+    checkGradients<Point2<K>, Point2<K>>(pp, p, c.head(2));
+    
+    dcm::numeric::Constraint<K, dcm::Distance, Point2<K>, Line2<K>> pl;
+    pl.distance() = 1;
+    Line2<K> l1;
+    l1.point() = Eigen::Vector2d(0,0);
+    l1.direction() = Eigen::Vector2d(2,0);
+    BOOST_CHECK_CLOSE(pl.calculateError(p2, l1), 3, 1e-10);
+    checkGradients<Point2<K>, Line2<K>>(pl, p, l);
+    p(1) = -2; //other side of the line
+    checkGradients<Point2<K>, Line2<K>>(pl, p, l);
+    
+    //a fixed line uses its precalculated normal, which must not change the results
+    dcm::numeric::Constraint<K, dcm::Distance, Point2<K>, Line2<K>> fixed;
+    fixed.distance() = 1;
+    Line2<K> lf;
+    set(lf, l);
+    fixed.prepareFixedSecond(lf);
+    for(double side : {-2., 2.}) {
+        p(1) = side;
+        Point2<K> pf, dpf;
+        set(pf, p);
+        dpf.point() = Eigen::Vector2d(0.3, -0.7);
+        BOOST_CHECK_CLOSE(fixed.calculateError(pf, lf), pl.calculateError(pf, lf), 1e-10);
+        BOOST_CHECK(fixed.calculateGradientFirstComplete(pf, lf).isApprox(pl.calculateGradientFirstComplete(pf, lf)));
+        BOOST_CHECK_CLOSE(fixed.calculateGradientFirst(pf, lf, dpf), pl.calculateGradientFirst(pf, lf, dpf), 1e-10);
+    }
+    
+    dcm::numeric::Constraint<K, dcm::Distance, Point2<K>, Circle2<K>> pc;
+    pc.distance() = 0;
+    checkGradients<Point2<K>, Circle2<K>>(pc, p, c);
+    
+    dcm::numeric::Constraint<K, dcm::Distance, Line2<K>, Circle2<K>> lc;
+    lc.distance() = 0;
+    checkGradients<Line2<K>, Circle2<K>>(lc, l, c);
+    checkGradients<Line2<K>, Circle2<K>>(lc, l, c2);
+    
+    dcm::numeric::Constraint<K, dcm::Distance, Circle2<K>, Circle2<K>> cc;
+    cc.distance() = 0;
+    checkGradients<Circle2<K>, Circle2<K>>(cc, c, c2);
+}
+
+BOOST_AUTO_TEST_CASE(angle_orientation) {
+    
+    Vector l1(4), l2(4);
+    l1 << 0, 0, 1, 0.2;
+    l2 << 1, 2, -0.5, 1.4;
+    
+    dcm::numeric::Constraint<K, dcm::Angle, Line2<K>, Line2<K>> a;
+    a.angle() = 0.3;
+    checkGradients<Line2<K>, Line2<K>>(a, l1, l2);
+    
+    dcm::numeric::Constraint<K, dcm::Orientation, Line2<K>, Line2<K>> o;
+    Line2<K> g1, g2;
+    set(g1, l1);
+    
+    o.orientation() = dcm::Orientations::Equal;
+    set(g2, l1);
+    BOOST_CHECK_SMALL(o.calculateError(g1, g2), 1e-12);
+    checkGradients<Line2<K>, Line2<K>>(o, l1, l2);
+    
+    o.orientation() = dcm::Orientations::Opposite;
+    set(g2, -l1);
+    BOOST_CHECK_SMALL(o.calculateError(g1, g2), 1e-12);
+    checkGradients<Line2<K>, Line2<K>>(o, l1, l2);
+    
+    o.orientation() = dcm::Orientations::Parallel;
+    BOOST_CHECK_SMALL(o.calculateError(g1, g2), 1e-12);
+    checkGradients<Line2<K>, Line2<K>>(o, l1, l2);
+    
+    o.orientation() = dcm::Orientations::Perpendicular;
+    g2.direction() = Eigen::Vector2d(-0.2, 1);
+    BOOST_CHECK_SMALL(o.calculateError(g1, g2), 1e-12);
+    checkGradients<Line2<K>, Line2<K>>(o, l1, l2);
+}
+
+BOOST_AUTO_TEST_CASE(fused_equation) {
+    
+    typedef dcm::numeric::Geometry<K, Line2>                                                    Line;
+    typedef dcm::numeric::ConstraintComplexEquation<K, dcm::Angle, Line2<K>, Line2<K>>         AngleEqn;
+    typedef dcm::numeric::ConstraintComplexEquation<K, dcm::Orientation, Line2<K>, Line2<K>>   OrientationEqn;
+    
+    dcm::numeric::LinearSystem<K> sys(8, 4);
+    auto l1 = std::make_shared<Line>();
+    auto l2 = std::make_shared<Line>();
+    l1->init(sys);
+    l2->init(sys);
+    
+    //the same constraints twice, once evaluated individually and once fused
+    std::vector<std::shared_ptr<dcm::numeric::ConstraintEquationBase<K, dcm::Angle, Line2<K>, Line2<K>>>> angles;
+    std::vector<std::shared_ptr<dcm::numeric::ConstraintEquationBase<K, dcm::Orientation, Line2<K>, Line2<K>>>> orientations;
+    for(int i=0; i<2; ++i) {
+        angles.push_back(std::make_shared<AngleEqn>());
+        angles.back()->setInputEquations(l1, l2);
+        angles.back()->angle() = 0.3;
+        angles.back()->init(sys);
+        orientations.push_back(std::make_shared<OrientationEqn>());
+        orientations.back()->setInputEquations(l1, l2);
+        orientations.back()->orientation() = dcm::Orientations::Parallel;
+        orientations.back()->init(sys);
+    }
+    
+    dcm::numeric::TypedConstraintEquationGenerator<K, dcm::Angle, Line2<K>, Line2<K>> generator;
+    auto fused = generator.buildFusedEquation(l1, l2, {angles[1], orientations[1]});
+    
+    for(int i=0; i<2; ++i) {
+        sys.parameter().setRandom();
+        l1->execute();
+        l2->execute();
+        angles[0]->execute();
+        orientations[0]->execute();
+        fused->execute();
+        
+        BOOST_CHECK_CLOSE(sys.residuals()(0), sys.residuals()(2), 1e-10);
+        BOOST_CHECK_CLOSE(sys.residuals()(1), sys.residuals()(3), 1e-10);
+        BOOST_CHECK(sys.jacobi().row(0).isApprox(sys.jacobi().row(2)));
+        BOOST_CHECK(sys.jacobi().row(1).isApprox(sys.jacobi().row(3)));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(module) {
+    
+    typedef dcm::System<K, dcm::Module2D> System;
+    
+    BOOST_CHECK((System::geometryIndex<Point2>::value == 0));
+    BOOST_CHECK((System::geometryIndex<Line2>::value == 1));
+    BOOST_CHECK((System::geometryIndex<Circle2>::value == 2));
+    
+    System sys;
+}
+
+BOOST_AUTO_TEST_SUITE_END();
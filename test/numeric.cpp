@@ -22,8 +22,10 @@
 #include "opendcm/core/equations.hpp"
 #include "opendcm/core/geometry.hpp"
 #include "opendcm/core/kernel.hpp"
+#include "opendcm/core/process.hpp"
 
 #include <boost/fusion/include/at.hpp>
+#include <memory>
 
 using namespace dcm;
 
@@ -345,4 +347,599 @@ BOOST_AUTO_TEST_CASE(parameter_geometry) {
 };
 
 
+BOOST_AUTO_TEST_CASE(array_conversion) {
+
+    BOOST_CHECK(TCylinder3<K>::ArraySize == 7);
+    BOOST_CHECK(TMatrix3<K>::ArraySize == 9);
+    
+    std::vector<double> data(7*10);
+    for(int i=0; i<data.size(); ++i)
+        data[i] = i;
+    
+    std::vector<TCylinder3<K>> cylinders(10);
+    const double* end = dcm::geometry::fromArray(&data[0], cylinders.begin(), cylinders.end());
+    BOOST_CHECK(end == &data[0] + data.size());
+    
+    BOOST_CHECK(cylinders[0].point().isApprox(Eigen::Vector3d(0,1,2)));
+    BOOST_CHECK(cylinders[0].radius() == 3);
+    BOOST_CHECK(cylinders[0].direction().isApprox(Eigen::Vector3d(4,5,6)));
+    BOOST_CHECK(cylinders[9].point().isApprox(Eigen::Vector3d(63,64,65)));
+    BOOST_CHECK(cylinders[9].direction().isApprox(Eigen::Vector3d(67,68,69)));
+    
+    std::vector<double> result(data.size(), -1);
+    dcm::geometry::toArray(&result[0], cylinders.begin(), cylinders.end());
+    BOOST_CHECK(result == data);
+    
+    //matrices are stored column major
+    TMatrix3<K> mat;
+    mat.fromArray(&data[0]);
+    BOOST_CHECK(mat.value().col(1).isApprox(Eigen::Vector3d(3,4,5)));
+};
+
+BOOST_AUTO_TEST_CASE(external_parameters) {
+
+    //parameters stored in user memory, every second value belongs to the system
+    std::vector<double> data(2*14, -1);
+    for(int i=0; i<14; ++i)
+        data[2*i] = i;
+    
+    numeric::LinearSystem<K> sys(&data[0], 14, 10, 2);
+    BOOST_CHECK(sys.parameter().size() == 14);
+    BOOST_CHECK(sys.parameter()(3) == 3);
+    
+    numeric::Geometry<K, TCylinder3> cyl1, cyl2;
+    cyl1.init(sys);
+    cyl2.init(sys);
+    
+    //the geometries read directly from the external memory
+    cyl1.execute();
+    cyl2.execute();
+    BOOST_CHECK(cyl1.point().isApprox(Eigen::Vector3d(0,1,2)));
+    BOOST_CHECK(cyl1.radius() == 3);
+    BOOST_CHECK(cyl2.direction().isApprox(Eigen::Vector3d(11,12,13)));
+    
+    //and changes to the system parameters end up in the external memory
+    sys.parameter()(7) = 42;
+    BOOST_CHECK(data[14] == 42);
+    BOOST_CHECK(data[15] == -1);
+    *cyl2.parameters()[3].Value = 24;
+    BOOST_CHECK(data[20] == 24);
+    cyl2.execute();
+    BOOST_CHECK(cyl2.point()(0) == 42);
+    BOOST_CHECK(cyl2.radius() == 24);
+};
+
+BOOST_AUTO_TEST_CASE(tangent_direction_geometry) {
+
+    numeric::LinearSystem<K> sys(20,20);
+    
+    numeric::TangentDirectionGeometry<K, TCylinder3, 2> cylGeom;
+    BOOST_CHECK(cylGeom.newParameterCount() == 6);
+    
+    cylGeom.direction() = Eigen::Vector3d(0,0,2);
+    cylGeom.init(sys);
+    BOOST_REQUIRE(cylGeom.parameters().size() == 6);
+    BOOST_REQUIRE(cylGeom.derivatives().size() == 6);
+    BOOST_CHECK(cylGeom.reference().isApprox(Eigen::Vector3d(0,0,1)));
+    
+    //point and radius are mapped directly, the direction not at all
+    for(int i=0; i<4; ++i) {
+        BOOST_CHECK(cylGeom.derivatives()[i].first.direction().isZero());
+        BOOST_CHECK(cylGeom.derivatives()[i].second == cylGeom.parameters()[i]);
+    }
+    BOOST_CHECK(cylGeom.derivatives()[3].first.radius() == 1);
+    BOOST_CHECK(cylGeom.derivatives()[4].first.point().isZero());
+    BOOST_CHECK(cylGeom.derivatives()[4].first.radius() == 0);
+    
+    sys.parameter().head<4>() << 1,2,3,4;
+    sys.parameter().segment<2>(4) << 0.3,-0.7;
+    cylGeom.execute();
+    
+    BOOST_CHECK(cylGeom.point().isApprox(Eigen::Vector3d(1,2,3)));
+    BOOST_CHECK(cylGeom.radius() == 4);
+    BOOST_CHECK_CLOSE(cylGeom.direction().norm(), 1., 1e-10);
+    
+    //compare the tangent derivatives with finite differences
+    for(int i=4; i<6; ++i) {
+        const Eigen::Vector3d dir = cylGeom.direction();
+        const Eigen::Vector3d der = cylGeom.derivatives()[i].first.direction();
+        sys.parameter()(i) += 1e-7;
+        cylGeom.execute();
+        BOOST_CHECK(((cylGeom.direction()-dir)/1e-7).isApprox(der, 1e-5));
+        sys.parameter()(i) -= 1e-7;
+        cylGeom.execute();
+    }
+    
+    //recentering must not change the direction but reset the tangent parameters
+    const Eigen::Vector3d dir = cylGeom.direction();
+    cylGeom.recenter();
+    BOOST_CHECK(sys.parameter().segment<2>(4).isZero());
+    cylGeom.execute();
+    BOOST_CHECK(cylGeom.direction().isApprox(dir));
+    BOOST_CHECK(cylGeom.reference().isApprox(dir));
+    BOOST_CHECK(cylGeom.derivatives()[4].first.direction().dot(dir) < 1e-12);
+    BOOST_CHECK(cylGeom.derivatives()[5].first.direction().dot(dir) < 1e-12);
+    
+    //a pure direction works without any further parameters
+    numeric::TangentDirectionGeometry<K, TDirection3, 0> dirGeom;
+    BOOST_CHECK(dirGeom.newParameterCount() == 2);
+    dirGeom.value() = Eigen::Vector3d(1,1,0);
+    dirGeom.init(sys);
+    BOOST_REQUIRE(dirGeom.parameters().size() == 2);
+    dirGeom.execute();
+    BOOST_CHECK(dirGeom.value().isApprox(Eigen::Vector3d(1,1,0).normalized()));
+    
+    //the tangent space only covers the half sphere around the reference, a target 150 degree away is 
+    //only reachable if the solver recenters the parametrization after its steps
+    numeric::LinearSystem<K> tsys(2,3);
+    numeric::TangentDirectionGeometry<K, TDirection3, 0> turning;
+    turning.value() = Eigen::Vector3d(0,0,1);
+    turning.init(tsys);
+    BOOST_CHECK(tsys.hasRecentering());
+    
+    const Eigen::Vector3d target(std::sin(M_PI*5/6), 0, std::cos(M_PI*5/6));
+    auto recalculate = [&]() {
+        turning.execute();
+        tsys.residuals() = turning.value() - target;
+        for(int i=0; i<2; ++i)
+            tsys.jacobi().col(i) = turning.derivatives()[i].first.value();
+    };
+    numeric::Dogleg<K> solver;
+    BOOST_CHECK(solver.solve(tsys, recalculate) == numeric::SolverResult::Converged);
+    BOOST_CHECK(turning.value().isApprox(target, 1e-8));
+    BOOST_CHECK(turning.reference().dot(target) > 0);
+    
+    //the same for the priority solver
+    turning.value() = Eigen::Vector3d(0,0,1);
+    turning.recenter();
+    numeric::PrioritySolver<K> psolver;
+    BOOST_CHECK(psolver.solve(tsys, recalculate) == numeric::SolverResult::Converged);
+    BOOST_CHECK(turning.value().isApprox(target, 1e-8));
+};
+
+BOOST_AUTO_TEST_CASE(dogleg) {
+
+    //intersection of a circle and a parabola
+    numeric::LinearSystem<K> sys(2,2);
+    auto recalculate = [&]() {
+        const Eigen::VectorXd x = sys.parameter();
+        sys.residuals() << x(0)*x(0) + x(1)*x(1) - 4, x(1) - x(0)*x(0);
+        sys.jacobi() << 2*x(0), 2*x(1), -2*x(0), 1;
+    };
+    
+    sys.parameter() << 3, 3;
+    numeric::Dogleg<K> solver;
+    BOOST_CHECK(solver.solve(sys, recalculate) == numeric::SolverResult::Converged);
+    BOOST_CHECK(sys.residuals().norm() < 1e-9);
+    
+    //overdetermined weighted system: x = 1 with weight 1 and x = 3 with weight 3
+    numeric::LinearSystem<K> wsys(1,2);
+    auto wrecalculate = [&]() {
+        wsys.residuals() << wsys.parameter()(0) - 1, wsys.parameter()(0) - 3;
+        wsys.jacobi() << 1, 1;
+    };
+    wsys.setResidualWeight(1, 3, 0);
+    wsys.parameter() << 0;
+    BOOST_CHECK(solver.solve(wsys, wrecalculate) != numeric::SolverResult::MaxIterations);
+    BOOST_CHECK_CLOSE(wsys.parameter()(0), 2.5, 1e-6);
+    
+    //the same intersection with the second parameter in a much smaller unit must behave identical due to
+    //the jacobian equilibration
+    sys.parameter() << 3, 3;
+    solver.solve(sys, recalculate);
+    const int iterations = solver.iter;
+    const Eigen::Vector2d solution = sys.parameter();
+    
+    const double s = 1e6;
+    auto srecalculate = [&]() {
+        const Eigen::VectorXd x = sys.parameter();
+        sys.residuals() << x(0)*x(0) + x(1)*x(1)/(s*s) - 4, x(1)/s - x(0)*x(0);
+        sys.jacobi() << 2*x(0), 2*x(1)/(s*s), -2*x(0), 1/s;
+    };
+    sys.parameter() << 3, 3*s;
+    BOOST_CHECK(solver.solve(sys, srecalculate) == numeric::SolverResult::Converged);
+    BOOST_CHECK_EQUAL(solver.iter, iterations);
+    BOOST_CHECK_CLOSE(sys.parameter()(0), solution(0), 1e-6);
+    BOOST_CHECK_CLOSE(sys.parameter()(1)/s, solution(1), 1e-6);
+    
+    //badly scaled equations are equilibrated for the normal equation backends too
+    auto rrecalculate = [&]() {
+        const Eigen::VectorXd x = sys.parameter();
+        sys.residuals() << s*s*(x(0)*x(0) + x(1)*x(1) - 4), x(1) - x(0)*x(0);
+        sys.jacobi() << 2*s*s*x(0), 2*s*s*x(1), -2*x(0), 1;
+    };
+    solver.linear.policy.backend = numeric::LinearBackend::DenseLDLT;
+    sys.parameter() << 3, 3;
+    BOOST_CHECK(solver.solve(sys, rrecalculate) == numeric::SolverResult::Converged);
+    BOOST_CHECK(sys.parameter().isApprox(solution, 1e-8));
+    solver.linear.policy.backend = numeric::LinearBackend::Automatic;
+    
+    //an already solved system returns after a single residual evaluation
+    int evaluations = 0;
+    auto crecalculate = [&]() {
+        ++evaluations;
+        recalculate();
+    };
+    sys.parameter() = solution;
+    BOOST_CHECK(solver.solve(sys, crecalculate) == numeric::SolverResult::Converged);
+    BOOST_CHECK_EQUAL(solver.iter, 0);
+    BOOST_CHECK_EQUAL(evaluations, 1);
+    BOOST_CHECK(sys.evaluation() == numeric::Evaluation::Full);
+    
+    //an unsolved system keeps the residuals of the check and adds the jacobian only
+    std::vector<numeric::Evaluation> modes;
+    auto mrecalculate = [&]() {
+        modes.push_back(sys.evaluation());
+        recalculate();
+    };
+    sys.parameter() << 3, 3;
+    BOOST_CHECK(solver.solve(sys, mrecalculate) == numeric::SolverResult::Converged);
+    BOOST_REQUIRE(modes.size() > 2);
+    BOOST_CHECK(modes[0] == numeric::Evaluation::Residuals);
+    BOOST_CHECK(modes[1] == numeric::Evaluation::Derivatives);
+    BOOST_CHECK(modes[2] == numeric::Evaluation::Full);
+};
+
+BOOST_AUTO_TEST_CASE(batch_solver) {
+
+    //many circle-parabola intersections with different radii
+    const int count = 200;
+    std::vector<std::unique_ptr<numeric::LinearSystem<K>>> systems;
+    std::vector<std::function<void()>> recalculate;
+    for(int i=0; i<count; ++i) {
+        systems.emplace_back(new numeric::LinearSystem<K>(2,2));
+        numeric::LinearSystem<K>& sys = *systems.back();
+        const double r = 1 + 0.01*i;
+        recalculate.push_back([&sys, r]() {
+            const Eigen::VectorXd x = sys.parameter();
+            sys.residuals() << x(0)*x(0) + x(1)*x(1) - r*r, x(1) - x(0)*x(0);
+            sys.jacobi() << 2*x(0), 2*x(1), -2*x(0), 1;
+        });
+    }
+    
+    numeric::BatchSolver<K> batch;
+    batch.grainsize = 8;
+    for(int round=0; round<2; ++round) {
+        for(int i=0; i<count; ++i) {
+            systems[i]->parameter() << 3, 3;
+            batch.add(*systems[i], recalculate[i]);
+        }
+        BOOST_CHECK_EQUAL(batch.size(), count);
+        
+        std::vector<numeric::BatchSolver<K>::Result> results = batch.solve();
+        BOOST_REQUIRE_EQUAL(results.size(), count);
+        BOOST_CHECK_EQUAL(batch.size(), 0);
+        
+        //every system must be solved exactly like with a sequential solver
+        numeric::Dogleg<K> solver;
+        for(int i=0; i<count; ++i) {
+            BOOST_CHECK(results[i].result == numeric::SolverResult::Converged);
+            BOOST_CHECK(systems[i]->residuals().norm() < 1e-9);
+            
+            const Eigen::Vector2d solution = systems[i]->parameter();
+            systems[i]->parameter() << 3, 3;
+            solver.solve(*systems[i], recalculate[i]);
+            BOOST_CHECK_EQUAL(results[i].iterations, solver.iter);
+            BOOST_CHECK(systems[i]->parameter().isApprox(solution));
+        }
+    }
+    
+    //the workers are kept between batches and dropped on reset
+    BOOST_CHECK(batch.workers() > 0);
+    batch.reset();
+    BOOST_CHECK_EQUAL(batch.workers(), 0);
+    
+    //bigger systems with a binary tree of 3 parameter blocks use the parallel block factorization, the
+    //nested tasks must not interfere with the workers of the batch
+    const int blocks = 127, n = 3*blocks, large = 8;
+    std::vector<int> sizes(blocks, 3);
+    std::vector<std::vector<int>> adjacency(blocks);
+    for(int b=1; b<blocks; ++b) {
+        adjacency[b].push_back((b-1)/2);
+        adjacency[(b-1)/2].push_back(b);
+    }
+    
+    std::vector<std::unique_ptr<numeric::LinearSystem<K>>> trees;
+    std::vector<std::function<void()>> treeRecalculate;
+    for(int s=0; s<large; ++s) {
+        trees.emplace_back(new numeric::LinearSystem<K>(n,n));
+        numeric::LinearSystem<K>& sys = *trees.back();
+        sys.setBlockStructure(sizes, adjacency);
+        treeRecalculate.push_back([&sys, n, s]() {
+            const Eigen::VectorXd x = sys.parameter();
+            sys.jacobi().setZero();
+            for(int k=0; k<n; ++k) {
+                const double target = 1 + 0.01*(k%7) + 0.1*s;
+                const double c = x(k)*x(k)*x(k) + x(k);
+                sys.residuals()(k) = c - target*target*target - target;
+                sys.jacobi()(k,k)  = 3*x(k)*x(k) + 1;
+                if(k >= 3) {
+                    const int p = 3*((k/3-1)/2) + k%3;
+                    const double pt = 1 + 0.01*(p%7) + 0.1*s;
+                    sys.residuals()(k) += 0.3*(x(p) - pt);
+                    sys.jacobi()(k,p)  = 0.3;
+                }
+            }
+        });
+    }
+    
+    for(int s=0; s<large; ++s) {
+        trees[s]->parameter().setOnes();
+        batch.add(*trees[s], treeRecalculate[s]);
+    }
+    std::vector<numeric::BatchSolver<K>::Result> results = batch.solve();
+    
+    numeric::Dogleg<K> solver;
+    for(int s=0; s<large; ++s) {
+        BOOST_CHECK(results[s].result == numeric::SolverResult::Converged);
+        BOOST_CHECK(trees[s]->residuals().norm() < 1e-9);
+        
+        const Eigen::VectorXd solution = trees[s]->parameter();
+        trees[s]->parameter().setOnes();
+        solver.solve(*trees[s], treeRecalculate[s]);
+        BOOST_CHECK(solver.linear.backend() == numeric::LinearBackend::SparseDirect);
+        BOOST_CHECK_EQUAL(results[s].iterations, solver.iter);
+        BOOST_CHECK(trees[s]->parameter().isApprox(solution));
+    }
+};
+
+BOOST_AUTO_TEST_CASE(process_solver) {
+
+    numeric::LinearSystem<K> sys(2,2);
+    int mode = 0;   //0 solve normally, 1 crash, 2 hang
+    auto recalculate = [&]() {
+        if(mode == 1)
+            raise(SIGKILL);
+        while(mode == 2)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        
+        const Eigen::VectorXd x = sys.parameter();
+        sys.residuals() << x(0)*x(0) + x(1)*x(1) - 4, x(1) - x(0)*x(0);
+        sys.jacobi() << 2*x(0), 2*x(1), -2*x(0), 1;
+    };
+    
+    sys.parameter() << 3, 3;
+    numeric::Dogleg<K> dogleg;
+    BOOST_REQUIRE(dogleg.solve(sys, recalculate) == numeric::SolverResult::Converged);
+    const Eigen::Vector2d solution = sys.parameter();
+    
+    //the isolated solving gives the same result and leaves a consistent system
+    sys.parameter() << 3, 3;
+    numeric::ProcessSolver<K> solver;
+    solver.timeout = 10;
+    solver.memoryLimit = 100*1024*1024;
+    BOOST_CHECK(solver.solve(sys, recalculate) == numeric::SolverResult::Converged);
+    BOOST_CHECK_EQUAL(solver.iter, dogleg.iter);
+    BOOST_CHECK(sys.parameter().isApprox(solution));
+    BOOST_CHECK(sys.residuals().norm() < 1e-9);
+    
+    //crashing and hanging solving runs do not affect the caller
+    sys.parameter() << 3, 3;
+    mode = 1;
+    BOOST_CHECK_THROW(solver.solve(sys, recalculate), dcm::solving_error);
+    BOOST_CHECK(sys.parameter().isApprox(Eigen::Vector2d(3,3)));
+    
+    mode = 2;
+    solver.timeout = 0.2;
+    BOOST_CHECK_THROW(solver.solve(sys, recalculate), dcm::solving_error);
+    BOOST_CHECK(sys.parameter().isApprox(Eigen::Vector2d(3,3)));
+    
+    mode = 0;
+    BOOST_CHECK(solver.solve(sys, recalculate) == numeric::SolverResult::Converged);
+    BOOST_CHECK(sys.parameter().isApprox(solution));
+    
+    //block systems are factorized serially in the child, also after the parent used the parallel one
+    const int n = 30;
+    numeric::LinearSystem<K> chain(n,n);
+    auto chainRecalculate = [&]() {
+        const Eigen::VectorXd x = chain.parameter();
+        chain.jacobi().setZero();
+        for(int i=0; i<n; ++i) {
+            const int j = (i+1)%n;
+            chain.residuals()(i) = x(i)*x(i) + 0.5*x(j) - 1.5 - 0.1*i;
+            chain.jacobi()(i,i) = 2*x(i);
+            chain.jacobi()(i,j) += 0.5;
+        }
+    };
+    std::vector<int> sizes(n/3, 3);
+    std::vector<std::vector<int>> adjacency(n/3);
+    for(int b=0; b<n/3; ++b) {
+        adjacency[b].push_back((b+1)%(n/3));
+        adjacency[(b+1)%(n/3)].push_back(b);
+    }
+    chain.setBlockStructure(sizes, adjacency);
+    
+    dogleg.linear.policy.backend = numeric::LinearBackend::SparseDirect;
+    chain.parameter().setOnes();
+    BOOST_REQUIRE(dogleg.solve(chain, chainRecalculate) == numeric::SolverResult::Converged);
+    const Eigen::VectorXd chainSolution = chain.parameter();
+    
+    numeric::ProcessSolver<K> blocks;
+    BOOST_CHECK(blocks.timeout > 0);
+    blocks.solver.linear.policy.backend = numeric::LinearBackend::SparseDirect;
+    chain.parameter().setOnes();
+    BOOST_CHECK(blocks.solve(chain, chainRecalculate) == numeric::SolverResult::Converged);
+    BOOST_CHECK(chain.parameter().isApprox(chainSolution));
+    BOOST_CHECK(blocks.solver.linear.parallel);
+};
+
+BOOST_AUTO_TEST_CASE(linear_backend) {
+
+    numeric::BackendPolicy policy;
+    BOOST_CHECK(policy.select(6, 10, 60) == numeric::LinearBackend::FixedDense);
+    BOOST_CHECK(policy.select(100, 100, 1000) == numeric::LinearBackend::DenseLDLT);
+    BOOST_CHECK(policy.select(5000, 5000, 60000) == numeric::LinearBackend::SparseDirect);
+    BOOST_CHECK(policy.select(5000, 5000, 10000000) == numeric::LinearBackend::DenseLDLT);
+    BOOST_CHECK(policy.select(40000, 40000, 500000) == numeric::LinearBackend::MatrixFree);
+    BOOST_CHECK(policy.select(10000, 10000, 60000) == numeric::LinearBackend::SparseDirect);
+    BOOST_CHECK(policy.select(10000, 10000, 60000, true) == numeric::LinearBackend::DomainDecomposition);
+    BOOST_CHECK(policy.select(1000, 1000, 6000, true) == numeric::LinearBackend::SparseDirect);
+    policy.backend = numeric::LinearBackend::DenseQR;
+    BOOST_CHECK(policy.select(6, 10, 60) == numeric::LinearBackend::DenseQR);
+    
+    //chain of 3 parameter blocks, every equation couples neighbouring parameters
+    const int n = 30;
+    numeric::LinearSystem<K> sys(n,n);
+    auto recalculate = [&]() {
+        const Eigen::VectorXd x = sys.parameter();
+        sys.jacobi().setZero();
+        for(int i=0; i<n; ++i) {
+            const int j = (i+1)%n;
+            sys.residuals()(i) = x(i)*x(i) + 0.5*x(j) - 1.5 - 0.1*i;
+            sys.jacobi()(i,i) = 2*x(i);
+            sys.jacobi()(i,j) += 0.5;
+        }
+    };
+    std::vector<int> sizes(n/3, 3);
+    std::vector<std::vector<int>> adjacency(n/3);
+    for(int b=0; b<n/3; ++b) {
+        adjacency[b].push_back((b+1)%(n/3));
+        adjacency[(b+1)%(n/3)].push_back(b);
+    }
+    sys.setBlockStructure(sizes, adjacency);
+    
+    numeric::Dogleg<K> solver;
+    for(numeric::LinearBackend backend : {numeric::LinearBackend::DenseLDLT, numeric::LinearBackend::DenseQR,
+                                          numeric::LinearBackend::SparseDirect, numeric::LinearBackend::DomainDecomposition,
+                                          numeric::LinearBackend::MatrixFree}) {
+        
+        sys.parameter().setOnes();
+        solver.linear.policy.backend = backend;
+        BOOST_CHECK(solver.solve(sys, recalculate) == numeric::SolverResult::Converged);
+        BOOST_CHECK(solver.linear.backend() == backend);
+        BOOST_CHECK(sys.residuals().norm() < 1e-9);
+    }
+    
+    //automatic selection of the decomposition for a large block structured system
+    solver.linear.policy.backend = numeric::LinearBackend::Automatic;
+    solver.linear.policy.denseLimit = 10;
+    solver.linear.policy.decompositionLimit = 20;
+    sys.parameter().setOnes();
+    BOOST_CHECK(solver.solve(sys, recalculate) == numeric::SolverResult::Converged);
+    BOOST_CHECK(solver.linear.backend() == numeric::LinearBackend::DomainDecomposition);
+    BOOST_CHECK(sys.residuals().norm() < 1e-9);
+    solver.linear.policy = numeric::BackendPolicy();
+    
+    //automatic selection for a tiny system
+    numeric::LinearSystem<K> tiny(2,2);
+    auto tinyRecalculate = [&]() {
+        const Eigen::VectorXd x = tiny.parameter();
+        tiny.residuals() << x(0)*x(0) + x(1)*x(1) - 4, x(1) - x(0)*x(0);
+        tiny.jacobi() << 2*x(0), 2*x(1), -2*x(0), 1;
+    };
+    tiny.parameter() << 3, 3;
+    BOOST_CHECK(solver.solve(tiny, tinyRecalculate) == numeric::SolverResult::Converged);
+    BOOST_CHECK(solver.linear.backend() == numeric::LinearBackend::FixedDense);
+};
+
+BOOST_AUTO_TEST_CASE(priority_solver) {
+
+    //hard: x0 + x1 = 1, soft: x0 = 3 (weight 4) and x1 = 0 (weight 1)
+    numeric::LinearSystem<K> sys(2,3);
+    auto recalculate = [&]() {
+        const Eigen::VectorXd x = sys.parameter();
+        sys.residuals() << x(0) + x(1) - 1, x(0) - 3, x(1);
+        sys.jacobi() << 1, 1, 1, 0, 0, 1;
+    };
+    sys.setResidualWeight(1, 4, 1);
+    sys.setResidualWeight(2, 1, 1);
+    sys.parameter().setZero();
+    
+    numeric::PrioritySolver<K> solver;
+    BOOST_CHECK(solver.solve(sys, recalculate) == numeric::SolverResult::Converged);
+    BOOST_CHECK(sys.parameter().isApprox(Eigen::Vector2d(2.6, -1.6), 1e-8));
+    BOOST_CHECK(solver.linear.backend() == numeric::LinearBackend::FixedDense);
+    
+    //hard: point on the unit circle, soft priority 1: x0 = 0.5, soft priority 2: x1 = 5. The second 
+    //soft level must not disturb the first one
+    numeric::LinearSystem<K> csys(2,3);
+    auto crecalculate = [&]() {
+        const Eigen::VectorXd x = csys.parameter();
+        csys.residuals() << x.squaredNorm() - 1, x(0) - 0.5, x(1) - 5;
+        csys.jacobi() << 2*x(0), 2*x(1), 1, 0, 0, 1;
+    };
+    csys.setResidualWeight(1, 1, 1);
+    csys.setResidualWeight(2, 100, 2);
+    csys.parameter() << 1, 1;
+    
+    BOOST_CHECK(solver.solve(csys, crecalculate) == numeric::SolverResult::Converged);
+    BOOST_CHECK(csys.parameter().isApprox(Eigen::Vector2d(0.5, std::sqrt(0.75)), 1e-8));
+    
+    //a system with all levels satisfied returns after a single residual evaluation
+    int evaluations = 0;
+    auto counted = [&]() {
+        ++evaluations;
+        recalculate();
+    };
+    sys.parameter() << 1, 0;
+    BOOST_CHECK(solver.solve(sys, counted) == numeric::SolverResult::Converged);
+    BOOST_CHECK(evaluations > 1);
+    
+    evaluations = 0;
+    auto satisfied = [&]() {
+        ++evaluations;
+        sys.residuals() << sys.parameter()(0) + sys.parameter()(1) - 1, 0, 0;
+        sys.jacobi() << 1, 1, 0, 0, 0, 0;
+    };
+    sys.parameter() << 1, 0;
+    BOOST_CHECK(solver.solve(sys, satisfied) == numeric::SolverResult::Converged);
+    BOOST_CHECK_EQUAL(solver.iter, 0);
+    BOOST_CHECK_EQUAL(evaluations, 1);
+};
+
+BOOST_AUTO_TEST_CASE(robust_loss) {
+
+    //all losses behave like the squared one for small residuals
+    for(numeric::Loss loss : {numeric::Loss::Huber, numeric::Loss::Cauchy, numeric::Loss::Tukey}) {
+        BOOST_CHECK_CLOSE(numeric::robustCost(loss, 1., 1e-3), 1e-6, 1e-3);
+        BOOST_CHECK_CLOSE(numeric::robustWeight(loss, 1., 1e-3), 1., 1e-3);
+        BOOST_CHECK(numeric::robustWeight(loss, 1., 10.) < 0.11);
+    }
+    BOOST_CHECK(numeric::robustWeight(numeric::Loss::Tukey, 1., 2.) == 0);
+    
+    //fit a line y = a*x + b through points with two gross outliers
+    const int count = 20;
+    numeric::LinearSystem<K> sys(2, count);
+    Eigen::VectorXd x = Eigen::VectorXd::LinSpaced(count, 0, 10);
+    Eigen::VectorXd y = 2*x.array() + 1;
+    y(3)  += 50;
+    y(15) -= 80;
+    
+    auto recalculate = [&]() {
+        const double a = sys.parameter()(0), b = sys.parameter()(1);
+        sys.residuals() = a*x.array() + b - y.array();
+        sys.jacobi().col(0) = x;
+        sys.jacobi().col(1).setOnes();
+    };
+    
+    //plain least squares gets pulled away by the outliers
+    numeric::Dogleg<K> solver;
+    sys.parameter().setZero();
+    solver.solve(sys, recalculate);
+    BOOST_CHECK((sys.parameter() - Eigen::Vector2d(2,1)).norm() > 1);
+    
+    //the losses are applied in order of increasing outlier rejection, each starting from the previous 
+    //result. That is needed for tukey, which ignores all residuals that start out too far away
+    const double tolerance[] = {0.2, 0.01, 1e-8};
+    int t = 0;
+    for(numeric::Loss loss : {numeric::Loss::Huber, numeric::Loss::Cauchy, numeric::Loss::Tukey}) {
+        
+        for(int i=0; i<count; ++i)
+            sys.setResidualLoss(i, loss, 1.);
+        
+        numeric::SolverResult result = solver.solve(sys, recalculate);
+        BOOST_CHECK(result != numeric::SolverResult::MaxIterations);
+        BOOST_CHECK(solver.iter < 100);
+        BOOST_CHECK_SMALL((sys.parameter() - Eigen::Vector2d(2,1)).norm(), tolerance[t++]);
+    }
+    
+    //with all residuals outside the tukey scale nothing is left to minimize, but the system is far 
+    //from solved and must not be reported as converged
+    sys.parameter() = Eigen::Vector2d(0, -5);
+    numeric::SolverResult result = solver.solve(sys, recalculate);
+    BOOST_CHECK(result == numeric::SolverResult::SmallGradient);
+    BOOST_CHECK(sys.residuals().cwiseAbs().minCoeff() > 1);
+    BOOST_CHECK(sys.parameter() == Eigen::Vector2d(0, -5));
+};
+
 BOOST_AUTO_TEST_SUITE_END();
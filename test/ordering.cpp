@@ -0,0 +1,185 @@
+/*
+    openDCM, dimensional constraint manager
+    Copyright (C) 2015  Stefan Troeger <stefantroeger@gmx.net>
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along
+    with this library; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <boost/test/unit_test.hpp>
+
+#include "opendcm/core/kernel.hpp"
+#include "opendcm/core/ordering.hpp"
+
+#include <random>
+#include <set>
+
+typedef dcm::Eigen3Kernel<double> K;
+typedef std::vector<std::vector<int>> Adjacency;
+
+//grid graph of size x size vertices
+Adjacency grid(int size) {
+    
+    Adjacency adj(size*size);
+    for(int i=0; i<size; ++i) {
+        for(int j=0; j<size; ++j) {
+            if(i+1 < size) {
+                adj[i*size+j].push_back((i+1)*size+j);
+                adj[(i+1)*size+j].push_back(i*size+j);
+            }
+            if(j+1 < size) {
+                adj[i*size+j].push_back(i*size+j+1);
+                adj[i*size+j+1].push_back(i*size+j);
+            }
+        }
+    }
+    return adj;
+};
+
+//number of fill edges created when eliminating the vertices in the given order
+int fill(const Adjacency& adj, const std::vector<int>& order) {
+    
+    std::vector<std::set<int>> graph(adj.size());
+    for(int i=0; i<adj.size(); ++i)
+        graph[i].insert(adj[i].begin(), adj[i].end());
+    
+    int fill = 0;
+    std::vector<bool> eliminated(adj.size(), false);
+    for(int v : order) {
+        std::vector<int> neighbours;
+        for(int n : graph[v]) 
+            if(!eliminated[n])
+                neighbours.push_back(n);
+            
+        for(int a : neighbours) {
+            for(int b : neighbours) {
+                if(a < b && graph[a].insert(b).second) {
+                    graph[b].insert(a);
+                    ++fill;
+                }
+            }
+        }
+        eliminated[v] = true;
+    }
+    return fill;
+};
+
+BOOST_AUTO_TEST_SUITE(Ordering_test_suit);
+
+BOOST_AUTO_TEST_CASE(nested_dissection) {
+
+    const Adjacency adj = grid(30);
+    std::vector<int> order = dcm::numeric::ordering::nestedDissection(adj);
+    
+    //must be a permutation
+    BOOST_REQUIRE(order.size() == adj.size());
+    std::vector<int> sorted = order;
+    std::sort(sorted.begin(), sorted.end());
+    for(int i=0; i<sorted.size(); ++i)
+        BOOST_CHECK(sorted[i] == i);
+    
+    std::vector<int> natural = sorted;
+    std::vector<int> random  = sorted;
+    std::shuffle(random.begin(), random.end(), std::mt19937(42));
+    
+    const int ndFill = fill(adj, order);
+    BOOST_CHECK(ndFill < fill(adj, natural)/2);
+    BOOST_CHECK(ndFill < fill(adj, random)/4);
+    
+    //disconnected graphs are handled too
+    Adjacency twice = adj;
+    for(const std::vector<int>& n : adj) {
+        twice.push_back(n);
+        for(int& v : twice.back())
+            v += adj.size();
+    }
+    order = dcm::numeric::ordering::nestedDissection(twice);
+    BOOST_CHECK(order.size() == twice.size());
+    BOOST_CHECK(std::set<int>(order.begin(), order.end()).size() == twice.size());
+}
+
+BOOST_AUTO_TEST_CASE(permutations) {
+
+    //three blocks: geometry, cluster, geometry, ordered as cluster first
+    std::vector<int> order = {1, 2, 0};
+    std::vector<int> sizes = {3, 6, 2};
+    std::vector<int> params = dcm::numeric::ordering::parameterPermutation(order, sizes);
+    std::vector<int> expected = {8, 9, 10, 0, 1, 2, 3, 4, 5, 6, 7};
+    BOOST_CHECK(params == expected);
+    
+    std::vector<std::pair<int,int>> equations = {{0,1}, {0,2}, {1,2}};
+    std::vector<int> eqs = dcm::numeric::ordering::equationPermutation(order, equations);
+    expected = {1, 2, 0};
+    BOOST_CHECK(eqs == expected);
+    
+    //the linear system must use the ordering when mapping
+    dcm::numeric::LinearSystem<K> sys(11, 3);
+    sys.setOrdering(params, eqs);
+    for(int i=0; i<11; ++i)
+        BOOST_CHECK(sys.mapParameter().Index == params[i]);
+    
+    Eigen::Map<Eigen::Vector3d> map(nullptr);
+    dcm::numeric::LinearSystem<K> sys2(11, 3);
+    sys2.setOrdering(params, eqs);
+    std::vector<dcm::numeric::VectorEntry<K>> entries = sys2.mapParameter(map);
+    BOOST_CHECK(entries[0].Index == 8 && entries[2].Index == 10);
+    BOOST_CHECK(map.data() == &sys2.parameter()(8));
+    
+    for(int i=0; i<3; ++i)
+        BOOST_CHECK(sys.mapResidual().Index == eqs[i]);
+}
+
+BOOST_AUTO_TEST_CASE(partition) {
+    
+    const int size = 40;
+    const Adjacency adj = grid(size);
+    std::vector<int> part = dcm::numeric::ordering::partition(adj, 4);
+    
+    //balanced parts, the grid can be cut with about 2*size edges
+    std::vector<int> count(4, 0);
+    int cut = 0;
+    for(int v=0; v<adj.size(); ++v) {
+        BOOST_REQUIRE(part[v] >= 0 && part[v] < 4);
+        ++count[part[v]];
+        for(int n : adj[v])
+            cut += (part[n] != part[v]) ? 1 : 0;
+    }
+    for(int c : count) 
+        BOOST_CHECK(std::abs(c - int(adj.size())/4) <= int(adj.size())/20);
+    BOOST_CHECK(cut/2 < 4*size);
+    
+    //the vertex separator decouples all parts
+    const int separator = dcm::numeric::ordering::separate(adj, part);
+    BOOST_CHECK(separator > 0 && separator < 3*size);
+    for(int v=0; v<adj.size(); ++v) {
+        if(part[v] == -1)
+            continue;
+        for(int n : adj[v])
+            BOOST_CHECK(part[n] == -1 || part[n] == part[v]);
+    }
+    
+    //weights balance the parameter count instead of the vertices
+    std::vector<int> weights(adj.size(), 1);
+    for(int i=0; i<adj.size()/4; ++i)
+        weights[i] = 6;
+    part = dcm::numeric::ordering::partition(adj, 2, weights);
+    int weight0 = 0, total = 0;
+    for(int v=0; v<adj.size(); ++v) {
+        total += weights[v];
+        weight0 += (part[v] == 0) ? weights[v] : 0;
+    }
+    BOOST_CHECK(std::abs(2*weight0 - total) <= total/20);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -238,9 +238,15 @@ BOOST_AUTO_TEST_CASE(convertion) {
     g->setProperty<symbolic::ConstraintProperty>(fusion::at_c<1>(e1), c1);
     g->setProperty<symbolic::ConstraintProperty>(fusion::at_c<1>(e2), c2);
 
-    symbolic::NumericConverter<K, typename Sys::GeometryList, typename Sys::ConstraintList, typename Sys::Graph> reducer;
+    typedef symbolic::NumericConverter<K, typename Sys::GeometryList, typename Sys::ConstraintList, typename Sys::Graph> Converter;
+    Converter reducer;
     reducer.setupEquationBuilder(g, fusion::at_c<0>(e1));
     
+    //the reduction trees and generators are shared, a converter itself holds no data
+    BOOST_CHECK(std::is_empty<Converter>::value);
+    BOOST_CHECK(&Converter::metadata() == &Converter::metadata());
+    BOOST_CHECK(Converter::metadata().treeArray[sg1->type][sg2->type] != nullptr);
+    
     //check the result
     numeric::EquationBuilder<K>* builder = g->getProperty<numeric::EquationBuilderProperty<K>>(fusion::at_c<0>(e1));
     BOOST_CHECK(builder != nullptr);
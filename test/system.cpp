@@ -274,5 +274,33 @@ BOOST_AUTO_TEST_CASE(signals) {
     BOOST_CHECK(s3.counter == 2);
 };*/
 
+struct VariantDispatcher {
+    typedef int result_type;
+    
+    int operator()(boost::blank&) {return -1;};
+    int operator()(int& i)         {return i;};
+    int operator()(std::string& s) {return s.size();};
+};
+
+BOOST_AUTO_TEST_CASE(variant_type_index) {
+    
+    struct TestVariant : public dcm::utilities::Variant<int, std::string> {
+        void set(int i)         {m_variant = i;};
+        void set(std::string s) {m_variant = s;};
+    } variant;
+    
+    VariantDispatcher dispatcher;
+    BOOST_CHECK(variant.typeIndex() == -1);
+    BOOST_CHECK(variant.apply(dispatcher) == -1);
+    
+    variant.set(5);
+    BOOST_CHECK(variant.typeIndex() == 0);
+    BOOST_CHECK(variant.apply(dispatcher) == 5);
+    
+    variant.set(std::string("test"));
+    BOOST_CHECK(variant.typeIndex() == 1);
+    BOOST_CHECK(variant.apply(dispatcher) == 4);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
 
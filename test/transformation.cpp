@@ -0,0 +1,86 @@
+/*
+    openDCM, dimensional constraint manager
+    Copyright (C) 2015  Stefan Troeger <stefantroeger@gmx.net>
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along
+    with this library; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <boost/test/unit_test.hpp>
+
+#include "opendcm/core/transformation.hpp"
+
+typedef dcm::details::Transform<double, 3> Transform;
+
+Transform randomTransform() {
+    
+    Eigen::Quaterniond q(Eigen::Vector4d::Random());
+    return Transform(q, Transform::Translation(Eigen::Vector3d::Random()), Transform::Scaling(1.5));
+};
+
+BOOST_AUTO_TEST_SUITE(Transformation_test_suit);
+
+BOOST_AUTO_TEST_CASE(batch_vectors) {
+
+    Transform t = randomTransform();
+    
+    Eigen::Matrix<double, 3, Eigen::Dynamic> points = Eigen::Matrix<double, 3, Eigen::Dynamic>::Random(3, 50);
+    Eigen::Matrix<double, 3, Eigen::Dynamic> directions = points;
+    Eigen::Matrix<double, 3, Eigen::Dynamic> original = points;
+    
+    t.transformPoints(points);
+    t.rotateDirections(directions);
+    
+    for(int i=0; i<original.cols(); ++i) {
+        
+        Eigen::Vector3d p = original.col(i);
+        BOOST_CHECK(points.col(i).isApprox(t*p));
+        t.rotate(p);
+        BOOST_CHECK(directions.col(i).isApprox(p));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(batch_transforms) {
+
+    dcm::details::TransformVector<double, 3> lhs, rhs, inv;
+    for(int i=0; i<20; ++i) {
+        lhs.push_back(randomTransform());
+        rhs.push_back(randomTransform());
+    }
+    
+    inv = lhs;
+    dcm::details::invert(inv);
+    for(int i=0; i<20; ++i) 
+        BOOST_CHECK(inv[i].isApprox(lhs[i].inverse(), 1e-10));
+    
+    dcm::details::TransformVector<double, 3> comp = lhs;
+    dcm::details::compose(comp, rhs);
+    for(int i=0; i<20; ++i) 
+        BOOST_CHECK(comp[i].isApprox(lhs[i]*rhs[i], 1e-10));
+    
+    Transform t = randomTransform();
+    comp = rhs;
+    dcm::details::compose(t, comp);
+    for(int i=0; i<20; ++i) 
+        BOOST_CHECK(comp[i].isApprox(t*rhs[i], 1e-10));
+    
+    //a transform composed with its inverse must not change points
+    comp = lhs;
+    dcm::details::compose(comp, inv);
+    Eigen::Vector3d p = Eigen::Vector3d::Random();
+    for(int i=0; i<20; ++i) 
+        BOOST_CHECK((comp[i]*p).isApprox(p, 1e-10));
+}
+
+BOOST_AUTO_TEST_SUITE_END();